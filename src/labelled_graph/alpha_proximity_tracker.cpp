@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Implementation of the AlphaProximityTracker class in 
+ * alpha_proximity_tracker.h
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>		/* for uint32_t */
+#include <algorithm>	/* for std::max */
+
+/* STL stuff in use. */
+#include <vector>
+
+#include "alpha_proximity_tracker.h" /* implementing this class. */
+
+AlphaProximityTracker::AlphaProximityTracker( std::vector< Rational > const& distances, 
+	Rational const& alpha ) : num_leaves_( 1 ), alpha_( alpha ), num_deficient_( 0 ), 
+	num_vertices_( distances.size() ), distance_sum_( 0 ) {
+
+	while( num_leaves_ < distances.size() ) { num_leaves_ *= 2; }
+	tree_.assign( 2 * num_leaves_, Rational{ 0, 1 } );
+
+	/* Fill the leaves, then build the internal nodes bottom-up in O(n). */
+	for( uint32_t v = 0; v < distances.size(); ++v ) {
+		tree_[ num_leaves_ + v ] = distances[ v ];
+		if( distances[ v ] > alpha_ ) { ++num_deficient_; }
+		distance_sum_ += distances[ v ].numerator / static_cast< double >( distances[ v ].denominator );
+	}
+	for( uint32_t i = num_leaves_ - 1; i > 0; --i ) {
+		tree_[ i ] = std::max( tree_[ 2 * i ], tree_[ 2 * i + 1 ] );
+	}
+}
+
+void AlphaProximityTracker::update( const uint32_t v, Rational const& distance ) {
+	uint32_t i = num_leaves_ + v;
+
+	/* Adjust the count of deficient vertices by the change in v's status. */
+	if( tree_[ i ] > alpha_ ) { --num_deficient_; }
+	if( distance > alpha_ ) { ++num_deficient_; }
+	distance_sum_ += distance.numerator / static_cast< double >( distance.denominator ) 
+		- tree_[ i ].numerator / static_cast< double >( tree_[ i ].denominator );
+	tree_[ i ] = distance;
+
+	/* Replay the tournament along the path to the root. */
+	for( i /= 2; i > 0; i /= 2 ) {
+		Rational const& winner = std::max( tree_[ 2 * i ], tree_[ 2 * i + 1 ] );
+		if( tree_[ i ] == winner ) { break; }
+		tree_[ i ] = winner;
+	}
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Definition of a tracker of the alpha-proximity of every vertex 
+ * of a LabelledGraph as edges are inserted.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ALPHA_PROXIMITY_TRACKER_H_
+#define ALPHA_PROXIMITY_TRACKER_H_
+
+#include <cstdint>	/* for uint32_t */
+
+/* STL libraries in use. */
+#include <vector>
+
+#include "rational.h"
+
+/**
+ * @brief Maintains the distance from each vertex's neighbourhood 
+ * LabelDistribution to the global one in a tournament tree, so that the 
+ * largest distance and the number of vertices further than alpha are 
+ * available in constant time after each O(log n) update.
+ */
+class AlphaProximityTracker {
+public:
+
+	/**
+	 * Constructs a tracker over the given initial distances.
+	 * @param distances The distance of each vertex's neighbourhood 
+	 * LabelDistribution to the global LabelDistribution.
+	 * @param alpha The privacy threshold
+	 */
+	AlphaProximityTracker( std::vector< Rational > const& distances, Rational const& alpha );
+
+	/**
+	 * Records a new distance for vertex v, e.g., because an edge incident 
+	 * to it was inserted.
+	 * @param v The vertex whose distance has changed
+	 * @param distance The new distance of v
+	 * @post The largest distance and the number of deficient vertices 
+	 * reflect the new distance, at a cost of O(log n).
+	 */
+	void update( const uint32_t v, Rational const& distance );
+
+	/**
+	 * Accessor method for the privacy threshold being tracked.
+	 * @return The alpha with which this tracker was constructed.
+	 */
+	Rational const& get_alpha() const { return alpha_; }
+
+	/**
+	 * Returns the largest distance of any vertex.
+	 * @return The largest distance, or 0 if there are no vertices.
+	 */
+	Rational const& max_distance() const { return tree_[ 1 ]; }
+
+	/**
+	 * Determines whether every vertex is within distance alpha.
+	 * @return True if the tracked graph is alpha-proximal
+	 * @see LabelledGraph::is_alpha_proximal()
+	 */
+	bool is_alpha_proximal() const { return num_deficient_ == 0; }
+
+	/**
+	 * Returns the number of vertices whose distance exceeds alpha.
+	 * @return The number of vertices that are not yet alpha-proximal.
+	 */
+	uint32_t num_deficient() const { return num_deficient_; }
+
+	/**
+	 * Returns the mean distance of the vertices, approximately.
+	 * @return The mean of the distances in double precision, or 0 if 
+	 * there are no vertices.
+	 */
+	double mean_distance() const { return num_vertices_ > 0 ? distance_sum_ / num_vertices_ : 0; }
+
+private:
+	/**
+	 * A complete binary max-tree stored as an array: node i has children 
+	 * 2i and 2i+1, and the distance of vertex v is stored at leaf 
+	 * num_leaves_ + v. Unused leaves hold 0.
+	 */
+	std::vector< Rational > tree_;
+	uint32_t num_leaves_; /**< The number of leaves, a power of two. */
+	Rational alpha_; /**< The privacy threshold. */
+	uint32_t num_deficient_; /**< The number of distances exceeding alpha_. */
+	uint32_t num_vertices_; /**< The number of distances tracked. */
+	double distance_sum_; /**< The sum of all distances, in double precision. */
+};
+
+#endif /* ALPHA_PROXIMITY_TRACKER_H_ */
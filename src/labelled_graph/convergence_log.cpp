@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Implementation of the ConvergenceLog class.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstdint>		/* for uint32_t */
+#include <fstream>		/* for std::ofstream */
+#include <sstream>		/* for std::ostringstream */
+
+/* STL stuff in use. */
+#include <vector>
+
+#include "convergence_log.h" /* implementing this class. */
+
+ConvergenceLog::ConvergenceLog( const char *path, const bool binary ) : binary_( binary ) {
+	out_.open( path, binary ? std::ios::out | std::ios::binary : std::ios::out );
+	buffer_.reserve( CONVERGENCE_LOG_BUFFER_SIZE );
+	if( out_.is_open() && !binary_ ) {
+		out_ << "alpha,iteration,new_edges,fallback_edges,num_deficient,max_distance,mean_distance,"
+			<< "step_seconds,check_seconds,fallback_seconds,check_share" << std::endl;
+	}
+}
+
+ConvergenceLog::~ConvergenceLog() {
+	flush();
+	out_.close();
+}
+
+void ConvergenceLog::flush() {
+	if( buffer_.empty() || !out_.is_open() ) { 
+		buffer_.clear();
+		return; 
+	}
+
+	if( binary_ ) {
+		out_.write( reinterpret_cast< const char* >( buffer_.data() ), buffer_.size() * sizeof( IterationRecord ) );
+	}
+	else {
+		/* Format the whole buffer first, so that it reaches the file in one write. */
+		std::ostringstream rows;
+		rows.precision( 9 );
+		for( auto const& r : buffer_ ) {
+			const double total_seconds = r.step_seconds + r.check_seconds + r.fallback_seconds;
+			rows << r.alpha << "," << r.iteration << "," << r.new_edges << "," << r.fallback_edges << "," 
+				<< r.num_deficient << "," << r.max_distance << "," << r.mean_distance << "," 
+				<< r.step_seconds << "," << r.check_seconds << "," << r.fallback_seconds << "," 
+				<< ( total_seconds > 0 ? r.check_seconds / total_seconds : 0 ) << "\n";
+		}
+		out_ << rows.str();
+	}
+	out_.flush();
+	buffer_.clear();
+}
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * @brief Definition of a buffered log of per-iteration convergence telemetry 
+ * for the alpha-proximity algorithms.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONVERGENCE_LOG_H_
+#define CONVERGENCE_LOG_H_
+
+#include <cstdint>	/* for uint32_t */
+#include <fstream>	/* for std::ofstream */
+
+/* STL libraries in use. */
+#include <vector>
+
+/**
+ * The number of records that a ConvergenceLog buffers before writing them.
+ */
+#define CONVERGENCE_LOG_BUFFER_SIZE 4096
+
+/**
+ * The telemetry of one iteration of an alpha-proximity algorithm. In a 
+ * binary log, each record is written as is, i.e., as 64 bytes of native-
+ * endian fields in this order.
+ */
+struct IterationRecord {
+	double alpha; /**< The privacy threshold that is being sought. */
+	uint32_t iteration; /**< The iteration number, from 0 for each run. */
+	uint32_t new_edges; /**< The edges added by the main step of the iteration. */
+	uint32_t fallback_edges; /**< The edges added because the main step added none. */
+	uint32_t num_deficient; /**< The number of vertices further than alpha afterwards. */
+	double max_distance; /**< The largest distance of any vertex afterwards. */
+	double mean_distance; /**< The mean distance of the vertices afterwards. */
+	double step_seconds; /**< The time spent in the main step. */
+	double check_seconds; /**< The time spent checking for alpha-proximity. */
+	double fallback_seconds; /**< The time spent adding fallback edges. */
+};
+
+/**
+ * @brief Collects IterationRecord s in memory and writes them to a file, 
+ * as CSV or binary, in batches of CONVERGENCE_LOG_BUFFER_SIZE.
+ */
+class ConvergenceLog {
+public:
+
+	/**
+	 * Opens a log file, truncating it, and writes the CSV header if needed.
+	 * @param path The path of the log file.
+	 * @param binary Whether to write raw IterationRecord s instead of CSV.
+	 */
+	ConvergenceLog( const char *path, const bool binary );
+
+	/**
+	 * Writes the buffered records and closes the log file.
+	 */
+	virtual ~ConvergenceLog();
+
+	/**
+	 * Determines whether the log file could be opened.
+	 * @return True if records can be written.
+	 */
+	bool is_open() const { return out_.is_open(); }
+
+	/**
+	 * Buffers a record, writing the buffer out once it is full.
+	 * @param record The telemetry of one iteration.
+	 */
+	void record( IterationRecord const& record ) {
+		buffer_.push_back( record );
+		if( buffer_.size() == CONVERGENCE_LOG_BUFFER_SIZE ) { flush(); }
+	}
+
+	/**
+	 * Writes all buffered records to the log file.
+	 */
+	void flush();
+
+private:
+	std::ofstream out_; /**< The log file. */
+	bool binary_; /**< Whether records are written raw rather than as CSV. */
+	std::vector< IterationRecord > buffer_; /**< The records not yet written. */
+};
+
+#endif /* CONVERGENCE_LOG_H_ */
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Implementation of the DeficiencySampler class.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <cstdint>		/* for uint32_t */
+#include <cstdlib>		/* for rand */
+
+/* STL stuff in use. */
+#include <vector>
+
+#include "deficiency_sampler.h" /* implementing this class. */
+
+DeficiencySampler::DeficiencySampler( std::vector< Deficiency > const& deficiencies, 
+	std::vector< double > const& weights ) : deficiencies_( deficiencies ), weights_( weights ), 
+	removed_( deficiencies.size(), 0 ) {
+
+	build();
+}
+
+void DeficiencySampler::build() {
+
+	/* First compact away the deficiencies that have been removed. */
+	uint32_t size = 0;
+	live_weight_ = 0;
+	for( uint32_t i = 0; i < deficiencies_.size(); ++i ) {
+		if( removed_[ i ] ) { continue; }
+		deficiencies_[ size ] = deficiencies_[ i ];
+		weights_[ size ] = weights_[ i ];
+		live_weight_ += weights_[ i ];
+		++size;
+	}
+	deficiencies_.resize( size );
+	weights_.resize( size );
+	removed_.assign( size, 0 );
+	num_live_ = size;
+	table_weight_ = live_weight_;
+
+	/* Then pair each underfull slot with an overfull one (Vose's variant). */
+	probabilities_.resize( size );
+	aliases_.resize( size );
+	std::vector< uint32_t > small, large;
+	for( uint32_t i = 0; i < size; ++i ) {
+		probabilities_[ i ] = weights_[ i ] * size / live_weight_;
+		aliases_[ i ] = i;
+		( probabilities_[ i ] < 1 ? small : large ).push_back( i );
+	}
+	while( !small.empty() && !large.empty() ) {
+		const uint32_t s = small.back(), l = large.back();
+		small.pop_back();
+		aliases_[ s ] = l;
+		probabilities_[ l ] -= 1 - probabilities_[ s ];
+		if( probabilities_[ l ] < 1 ) {
+			large.pop_back();
+			small.push_back( l );
+		}
+	}
+
+	/* Whatever remains is full, up to rounding. */
+	for( auto const i : small ) { probabilities_[ i ] = 1; }
+	for( auto const i : large ) { probabilities_[ i ] = 1; }
+}
+
+uint32_t DeficiencySampler::sample() {
+	if( live_weight_ < table_weight_ / 2 ) { build(); }
+
+	while( true ) {
+		const uint32_t slot = rand() % deficiencies_.size();
+		const double coin = rand() / ( RAND_MAX + 1.0 );
+		const uint32_t i = ( coin < probabilities_[ slot ] ? slot : aliases_[ slot ] );
+		if( !removed_[ i ] ) { return i; }
+	}
+}
+
+void DeficiencySampler::remove( const uint32_t i ) {
+	if( removed_[ i ] ) { return; }
+	removed_[ i ] = 1;
+	--num_live_;
+	live_weight_ -= weights_[ i ];
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Definition of an alias-table sampler over the label deficiencies of 
+ * vertices, from which fallback edges are drawn.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEFICIENCY_SAMPLER_H_
+#define DEFICIENCY_SAMPLER_H_
+
+#include <cstdint>	/* for uint32_t */
+
+/* STL libraries in use. */
+#include <vector>
+
+/**
+ * A vertex that lacks a label of an attribute in its neighbourhood.
+ */
+struct Deficiency {
+	uint32_t vertex; /**< The deficient vertex. */
+	uint32_t attribute; /**< The attribute in which it is deficient. */
+	uint32_t label; /**< The label that it lacks. */
+};
+
+/**
+ * @brief Samples label deficiencies in proportion to their weights in O(1) 
+ * expected time with Walker's alias method.
+ * 
+ * Deficiencies that clear are removed lazily: they stay in the alias table 
+ * but are rejected when drawn. Once they carry half of the weight, the table 
+ * is rebuilt from the remaining ones, so that a draw takes at most two tries 
+ * in expectation and the rebuilds cost O(1) amortised per removal.
+ */
+class DeficiencySampler {
+public:
+
+	/**
+	 * Constructs a sampler over the given deficiencies.
+	 * @param deficiencies The deficiencies to sample from.
+	 * @param weights The positive weight of each deficiency.
+	 */
+	DeficiencySampler( std::vector< Deficiency > const& deficiencies, std::vector< double > const& weights );
+
+	/**
+	 * Determines whether any deficiency remains.
+	 * @return True if every deficiency has been removed.
+	 */
+	bool empty() const { return num_live_ == 0; }
+
+	/**
+	 * Draws a remaining deficiency with probability proportional to its 
+	 * weight, using rand().
+	 * @return The index of the drawn deficiency.
+	 * @pre !empty()
+	 */
+	uint32_t sample();
+
+	/**
+	 * Accessor method for a deficiency.
+	 * @param i The index of the deficiency, e.g., as returned by sample().
+	 * @return The i'th deficiency.
+	 */
+	Deficiency const& get( const uint32_t i ) const { return deficiencies_[ i ]; }
+
+	/**
+	 * Removes a deficiency so that it is never drawn again, e.g., because 
+	 * it has cleared.
+	 * @param i The index of the deficiency, as returned by sample().
+	 */
+	void remove( const uint32_t i );
+
+private:
+	/**
+	 * (Re)builds the alias table over the deficiencies that remain.
+	 */
+	void build();
+
+	std::vector< Deficiency > deficiencies_; /**< The deficiencies in the table. */
+	std::vector< double > weights_; /**< The weight of each deficiency. */
+	/**
+	 * The probability with which a draw of slot i keeps deficiency i 
+	 * rather than taking aliases_[ i ].
+	 */
+	std::vector< double > probabilities_;
+	std::vector< uint32_t > aliases_; /**< @see probabilities_ */
+	std::vector< char > removed_; /**< Whether each deficiency has been removed. */
+	uint32_t num_live_; /**< The number of deficiencies not yet removed. */
+	double live_weight_; /**< The total weight of those deficiencies. */
+	double table_weight_; /**< The total weight when the table was last built. */
+};
+
+#endif /* DEFICIENCY_SAMPLER_H_ */
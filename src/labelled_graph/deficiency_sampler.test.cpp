@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @brief A set of functions for unit testing the DeficiencySampler class.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint> /* for uint32_t */
+#include <cstdlib> /* for rand, srand */
+#include <vector>
+
+#include "deficiency_sampler.test.h"
+#include "deficiency_sampler.h"
+
+/**
+ * Draws repeatedly from a sampler and checks that each deficiency is drawn 
+ * with about the expected frequency.
+ * @param sampler The sampler from which to draw.
+ * @param expected The expected frequency of each index that sample() may 
+ * return (zero for removed deficiencies).
+ * @return True if every frequency is within 0.01 of the expected one.
+ */
+static bool frequencies_match( DeficiencySampler *sampler, std::vector< double > const& expected ) {
+
+	const uint32_t num_draws = 100000;
+	std::vector< uint32_t > draws( expected.size(), 0 );
+	for( uint32_t k = 0; k < num_draws; ++k ) {
+		const uint32_t i = sampler->sample();
+		if( i >= expected.size() ) { return false; }
+		++draws[ i ];
+	}
+	for( uint32_t i = 0; i < expected.size(); ++i ) {
+		const double frequency = draws[ i ] / (double) num_draws;
+		if( frequency < expected[ i ] - 0.01 || frequency > expected[ i ] + 0.01 ) { return false; }
+	}
+	return true;
+}
+
+bool test_deficiency_sampler() {
+
+	bool passed = true;
+
+	/* Draw from a fixed sequence, then reseed rand() from where it was, so 
+	 * that the graph's random choices still follow its own seed. */
+	const unsigned seed = rand();
+	srand( 1 );
+
+	/**
+	 * @test Alias table
+	 * Deficiencies of weights 1, 2, 3, and 4 are drawn with frequencies 
+	 * of about 0.1, 0.2, 0.3, and 0.4.
+	 */
+	std::vector< Deficiency > deficiencies;
+	for( uint32_t i = 0; i < 4; ++i ) { deficiencies.push_back( Deficiency{ i, 0, 10 + i } ); }
+	DeficiencySampler *sampler = new DeficiencySampler( deficiencies, { 1, 2, 3, 4 } );
+	if( sampler->empty() ) { passed = false; }
+	if( !frequencies_match( sampler, { 0.1, 0.2, 0.3, 0.4 } ) ) { passed = false; }
+
+	/**
+	 * @test Lazy removal
+	 * Removing the deficiencies of weights 1 and 3 leaves 6 of the 10 units 
+	 * of weight, so the table is not rebuilt: the other two keep their 
+	 * indices and are drawn in proportion 2 : 4, and the removed ones are 
+	 * never drawn. Removing a deficiency twice has no further effect.
+	 */
+	sampler->remove( 0 );
+	sampler->remove( 2 );
+	sampler->remove( 2 );
+	if( sampler->empty() ) { passed = false; }
+	if( !frequencies_match( sampler, { 0, 1.0 / 3, 0, 2.0 / 3 } ) ) { passed = false; }
+	if( sampler->get( 3 ).label != 13 ) { passed = false; }
+
+	/**
+	 * @test Rebuild at half weight
+	 * Removing the deficiency of weight 4 as well leaves less than half of 
+	 * the weight, so the next draw rebuilds the table over the one that 
+	 * remains, which moves to index 0.
+	 */
+	sampler->remove( 3 );
+	if( sampler->empty() ) { passed = false; }
+	if( !frequencies_match( sampler, { 1 } ) ) { passed = false; }
+	if( sampler->get( 0 ).vertex != 1 || sampler->get( 0 ).label != 11 ) { passed = false; }
+
+	/**
+	 * @test Emptying
+	 * Once every deficiency is removed, the sampler is empty.
+	 */
+	sampler->remove( 0 );
+	if( !sampler->empty() ) { passed = false; }
+	delete sampler;
+
+	srand( seed );
+	return passed;
+}
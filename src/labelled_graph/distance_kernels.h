@@ -0,0 +1,466 @@
+/**
+ * @file
+ * @brief The proximity metrics with which neighbourhood label distributions 
+ * are compared to the global one, as compile-time policies, each with a 
+ * rule for a single neighbourhood and a batch kernel for many at once.
+ * @see label_distribution.h for the distance and deficiencies of a single 
+ * neighbourhood under a metric.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DISTANCE_KERNELS_H_
+#define DISTANCE_KERNELS_H_
+
+#include <cstdint>	/* for uint32_t, uint64_t, int64_t */
+#include <cmath>	/* for std::log, std::llround */
+
+#ifdef __AVX2__
+#include <immintrin.h>	/* for AVX2 intrinsics */
+#endif
+
+#include "rational.h"
+
+/**
+ * The number of vertices whose label counts are laid out together in one 
+ * structure-of-arrays block.
+ */
+#define DISTANCE_BLOCK_SIZE 64
+
+/**
+ * The largest alphabet size for which the distance kernels are specialised.
+ */
+#define MAX_FIXED_LABELS 8
+
+/**
+ * The fixed-point denominator of KL divergences, which are irrational.
+ */
+#define KL_DENOMINATOR ( UINT64_C( 1 ) << 32 )
+
+/*
+ * Every metric below is a policy class with the same static interface:
+ * 
+ * - denominator( sum, global_sum, num_labels ) gives the common denominator 
+ *   of the distances of a neighbourhood whose counts sum to sum;
+ * - distance( counts, sum, global, global_sum, num_labels ) computes the 
+ *   distance of one neighbourhood from its label counts, which is also the 
+ *   rule with which a distance is updated after a single-edge change (since 
+ *   the sum of the counts changes, every label contributes anew, in O(l));
+ * - deficiency_distance( ... ) is the distance below alpha of which a 
+ *   neighbourhood is not considered deficient in any label;
+ * - block< fixed_labels >( ... ) computes the numerators of both distances 
+ *   and the deficient labels of DISTANCE_BLOCK_SIZE neighbourhoods at once.
+ * 
+ * The counts of a block are in structure-of-arrays layout, i.e., the count 
+ * of label i in the j'th neighbourhood is counts[ i * DISTANCE_BLOCK_SIZE + j ], 
+ * so that consecutive neighbourhoods fill consecutive vector lanes, and the 
+ * sums of the neighbourhoods must be positive (also in the unused lanes of a 
+ * partial block). Over the common denominator sums[ j ] * global_sum, the 
+ * pairwise difference for label i has the numerator 
+ * counts[ i ][ j ] * global_sum - global[ i ] * sums[ j ], and the neighbourhood 
+ * is deficient in label i if it is negative. Only the first 64 labels are 
+ * represented in the deficiency bitmasks.
+ */
+
+#ifdef __AVX2__
+/**
+ * Loads the counts of four neighbourhoods into 64-bit lanes and computes 
+ * their pairwise differences for one label.
+ * @return The numerators of the pairwise differences.
+ */
+inline __m256i pairwise_differences( uint32_t const* counts, const __m256i lane_sums, 
+	const __m256i global_sums, const uint32_t global_count ) {
+
+	const __m256i lane_counts = _mm256_cvtepu32_epi64( 
+		_mm_loadu_si128( reinterpret_cast< __m128i const* >( counts ) ) );
+	return _mm256_sub_epi64( _mm256_mul_epu32( lane_counts, global_sums ), 
+		_mm256_mul_epu32( _mm256_set1_epi64x( global_count ), lane_sums ) );
+}
+
+/**
+ * Computes the absolute values of four signed 64-bit lanes.
+ * @param negative The lanes of values that are negative, as all ones.
+ */
+inline __m256i absolute_values( const __m256i values, const __m256i negative ) {
+	return _mm256_sub_epi64( _mm256_xor_si256( values, negative ), negative );
+}
+
+/**
+ * Sets bit i of each of four deficiency masks whose lane is negative.
+ */
+inline void mark_deficiencies( const __m256i negative, const uint32_t i, uint64_t *masks ) {
+	if( i >= 64 ) { return; }
+	const uint64_t lanes = _mm256_movemask_pd( _mm256_castsi256_pd( negative ) );
+	for( uint32_t k = 0; k < 4; ++k ) { masks[ k ] |= ( ( lanes >> k ) & 1 ) << i; }
+}
+#endif
+
+/**
+ * Computes the numerator of the pairwise difference of one neighbourhood 
+ * for one label, over the denominator sum * global_sum.
+ */
+inline int64_t pairwise_difference( const uint32_t count, const uint32_t sum, 
+	const uint32_t global_count, const uint32_t global_sum ) {
+	return static_cast< int64_t >( static_cast< uint64_t >( count ) * global_sum ) 
+		- static_cast< int64_t >( static_cast< uint64_t >( global_count ) * sum );
+}
+
+/**
+ * @brief The L1 distance over all but the last label, as in Definition 2.4 
+ * of @cite asonam . A neighbourhood is deficient unless the L1 distance over 
+ * all labels is below alpha.
+ */
+struct L1Distance {
+
+	static uint64_t denominator( const uint32_t sum, const uint32_t global_sum, const uint32_t ) {
+		return static_cast< uint64_t >( sum ) * global_sum;
+	}
+
+	static Rational distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+
+		uint64_t difference = 0;
+		for( uint32_t i = 0; i + 1 < num_labels; ++i ) {
+			const int64_t pairwise_diff = pairwise_difference( counts[ i ], sum, global[ i ], global_sum );
+			difference += ( pairwise_diff < 0 ? -pairwise_diff : pairwise_diff );
+		}
+		return Rational{ difference, denominator( sum, global_sum, num_labels ) };
+	}
+
+	static Rational deficiency_distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+
+		uint64_t difference = 0;
+		for( uint32_t i = 0; i < num_labels; ++i ) {
+			const int64_t pairwise_diff = pairwise_difference( counts[ i ], sum, global[ i ], global_sum );
+			difference += ( pairwise_diff < 0 ? -pairwise_diff : pairwise_diff );
+		}
+		return Rational{ difference, denominator( sum, global_sum, num_labels ) };
+	}
+
+	template < uint32_t fixed_labels >
+	static void block( uint32_t const* counts, uint32_t const* sums, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels, 
+		uint64_t *distances, uint64_t *differences, uint64_t *deficiencies ) {
+
+		const uint32_t length = ( fixed_labels > 0 ? fixed_labels : num_labels );
+
+#ifdef __AVX2__
+		/* Four neighbourhoods per 256-bit vector of 64-bit lanes. */
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i global_sums = _mm256_set1_epi64x( global_sum );
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; j += 4 ) {
+			const __m256i lane_sums = _mm256_cvtepu32_epi64( 
+				_mm_loadu_si128( reinterpret_cast< __m128i const* >( sums + j ) ) );
+			__m256i distance = zero, difference = zero;
+			uint64_t masks[ 4 ] = { 0, 0, 0, 0 };
+
+			for( uint32_t i = 0; i < length; ++i ) {
+				const __m256i pairwise_diff = pairwise_differences( counts + i * DISTANCE_BLOCK_SIZE + j, 
+					lane_sums, global_sums, global[ i ] );
+				const __m256i deficient = _mm256_cmpgt_epi64( zero, pairwise_diff );
+				const __m256i absolute = absolute_values( pairwise_diff, deficient );
+				if( i + 1 < length ) { distance = _mm256_add_epi64( distance, absolute ); }
+				difference = _mm256_add_epi64( difference, absolute );
+				mark_deficiencies( deficient, i, masks );
+			}
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( distances + j ), distance );
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( differences + j ), difference );
+			for( uint32_t k = 0; k < 4; ++k ) { deficiencies[ j + k ] = masks[ k ]; }
+		}
+#else
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+			distances[ j ] = differences[ j ] = deficiencies[ j ] = 0;
+		}
+		for( uint32_t i = 0; i < length; ++i ) {
+			for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+				const int64_t pairwise_diff = pairwise_difference( counts[ i * DISTANCE_BLOCK_SIZE + j ], 
+					sums[ j ], global[ i ], global_sum );
+				const uint64_t absolute = ( pairwise_diff < 0 ? -pairwise_diff : pairwise_diff );
+				if( i + 1 < length ) { distances[ j ] += absolute; }
+				differences[ j ] += absolute;
+				if( i < 64 && pairwise_diff < 0 ) { deficiencies[ j ] |= UINT64_C( 1 ) << i; }
+			}
+		}
+#endif
+	}
+};
+
+/**
+ * @brief The Earth Mover's Distance between distributions over an ordinal 
+ * attribute, i.e., the summed absolute cumulative differences normalised by 
+ * the l - 1 steps between consecutive labels, as in t-closeness.
+ */
+struct EarthMoversDistance {
+
+	static uint64_t denominator( const uint32_t sum, const uint32_t global_sum, const uint32_t num_labels ) {
+		return static_cast< uint64_t >( sum ) * global_sum * ( num_labels > 1 ? num_labels - 1 : 1 );
+	}
+
+	static Rational distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+
+		int64_t cumulative_diff = 0;
+		uint64_t difference = 0;
+		for( uint32_t i = 0; i + 1 < num_labels; ++i ) {
+			cumulative_diff += pairwise_difference( counts[ i ], sum, global[ i ], global_sum );
+			difference += ( cumulative_diff < 0 ? -cumulative_diff : cumulative_diff );
+		}
+		return Rational{ difference, denominator( sum, global_sum, num_labels ) };
+	}
+
+	static Rational deficiency_distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+		return distance( counts, sum, global, global_sum, num_labels );
+	}
+
+	template < uint32_t fixed_labels >
+	static void block( uint32_t const* counts, uint32_t const* sums, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels, 
+		uint64_t *distances, uint64_t *differences, uint64_t *deficiencies ) {
+
+		const uint32_t length = ( fixed_labels > 0 ? fixed_labels : num_labels );
+
+#ifdef __AVX2__
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i global_sums = _mm256_set1_epi64x( global_sum );
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; j += 4 ) {
+			const __m256i lane_sums = _mm256_cvtepu32_epi64( 
+				_mm_loadu_si128( reinterpret_cast< __m128i const* >( sums + j ) ) );
+			__m256i cumulative_diff = zero, distance = zero;
+			uint64_t masks[ 4 ] = { 0, 0, 0, 0 };
+
+			for( uint32_t i = 0; i < length; ++i ) {
+				const __m256i pairwise_diff = pairwise_differences( counts + i * DISTANCE_BLOCK_SIZE + j, 
+					lane_sums, global_sums, global[ i ] );
+				mark_deficiencies( _mm256_cmpgt_epi64( zero, pairwise_diff ), i, masks );
+				if( i + 1 < length ) {
+					cumulative_diff = _mm256_add_epi64( cumulative_diff, pairwise_diff );
+					distance = _mm256_add_epi64( distance, absolute_values( cumulative_diff, 
+						_mm256_cmpgt_epi64( zero, cumulative_diff ) ) );
+				}
+			}
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( distances + j ), distance );
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( differences + j ), distance );
+			for( uint32_t k = 0; k < 4; ++k ) { deficiencies[ j + k ] = masks[ k ]; }
+		}
+#else
+		int64_t cumulative_diffs[ DISTANCE_BLOCK_SIZE ];
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+			distances[ j ] = deficiencies[ j ] = 0;
+			cumulative_diffs[ j ] = 0;
+		}
+		for( uint32_t i = 0; i < length; ++i ) {
+			for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+				const int64_t pairwise_diff = pairwise_difference( counts[ i * DISTANCE_BLOCK_SIZE + j ], 
+					sums[ j ], global[ i ], global_sum );
+				if( i < 64 && pairwise_diff < 0 ) { deficiencies[ j ] |= UINT64_C( 1 ) << i; }
+				if( i + 1 < length ) {
+					cumulative_diffs[ j ] += pairwise_diff;
+					distances[ j ] += ( cumulative_diffs[ j ] < 0 ? -cumulative_diffs[ j ] : cumulative_diffs[ j ] );
+				}
+			}
+		}
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) { differences[ j ] = distances[ j ]; }
+#endif
+	}
+};
+
+/**
+ * @brief The largest absolute difference between the relative frequencies 
+ * of any label (i.e., the L-infinity or max-norm distance).
+ */
+struct MaxNormDistance {
+
+	static uint64_t denominator( const uint32_t sum, const uint32_t global_sum, const uint32_t ) {
+		return static_cast< uint64_t >( sum ) * global_sum;
+	}
+
+	static Rational distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+
+		uint64_t difference = 0;
+		for( uint32_t i = 0; i < num_labels; ++i ) {
+			const int64_t pairwise_diff = pairwise_difference( counts[ i ], sum, global[ i ], global_sum );
+			const uint64_t absolute = ( pairwise_diff < 0 ? -pairwise_diff : pairwise_diff );
+			if( absolute > difference ) { difference = absolute; }
+		}
+		return Rational{ difference, denominator( sum, global_sum, num_labels ) };
+	}
+
+	static Rational deficiency_distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+		return distance( counts, sum, global, global_sum, num_labels );
+	}
+
+	template < uint32_t fixed_labels >
+	static void block( uint32_t const* counts, uint32_t const* sums, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels, 
+		uint64_t *distances, uint64_t *differences, uint64_t *deficiencies ) {
+
+		const uint32_t length = ( fixed_labels > 0 ? fixed_labels : num_labels );
+
+#ifdef __AVX2__
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i global_sums = _mm256_set1_epi64x( global_sum );
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; j += 4 ) {
+			const __m256i lane_sums = _mm256_cvtepu32_epi64( 
+				_mm_loadu_si128( reinterpret_cast< __m128i const* >( sums + j ) ) );
+			__m256i distance = zero;
+			uint64_t masks[ 4 ] = { 0, 0, 0, 0 };
+
+			for( uint32_t i = 0; i < length; ++i ) {
+				const __m256i pairwise_diff = pairwise_differences( counts + i * DISTANCE_BLOCK_SIZE + j, 
+					lane_sums, global_sums, global[ i ] );
+				const __m256i deficient = _mm256_cmpgt_epi64( zero, pairwise_diff );
+				const __m256i absolute = absolute_values( pairwise_diff, deficient );
+
+				/* The absolute values are non-negative, so a signed maximum suffices. */
+				distance = _mm256_blendv_epi8( distance, absolute, _mm256_cmpgt_epi64( absolute, distance ) );
+				mark_deficiencies( deficient, i, masks );
+			}
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( distances + j ), distance );
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( differences + j ), distance );
+			for( uint32_t k = 0; k < 4; ++k ) { deficiencies[ j + k ] = masks[ k ]; }
+		}
+#else
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) { distances[ j ] = deficiencies[ j ] = 0; }
+		for( uint32_t i = 0; i < length; ++i ) {
+			for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+				const int64_t pairwise_diff = pairwise_difference( counts[ i * DISTANCE_BLOCK_SIZE + j ], 
+					sums[ j ], global[ i ], global_sum );
+				const uint64_t absolute = ( pairwise_diff < 0 ? -pairwise_diff : pairwise_diff );
+				if( absolute > distances[ j ] ) { distances[ j ] = absolute; }
+				if( i < 64 && pairwise_diff < 0 ) { deficiencies[ j ] |= UINT64_C( 1 ) << i; }
+			}
+		}
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) { differences[ j ] = distances[ j ]; }
+#endif
+	}
+};
+
+/**
+ * @brief The Kullback-Leibler divergence of a neighbourhood's distribution 
+ * from the global one. Since it is irrational, it is rounded to a multiple 
+ * of 1 / KL_DENOMINATOR, identically by distance() and block().
+ */
+struct KLDivergence {
+
+	static uint64_t denominator( const uint32_t, const uint32_t, const uint32_t ) { return KL_DENOMINATOR; }
+
+	/**
+	 * Computes the contribution of one label to the divergence. Labels absent 
+	 * from the neighbourhood contribute nothing, and every label present in 
+	 * it is also present globally.
+	 */
+	static double term( const uint32_t count, const uint32_t sum, 
+		const uint32_t global_count, const uint32_t global_sum ) {
+		if( count == 0 ) { return 0; }
+		return ( static_cast< double >( count ) / sum ) * std::log( 
+			( static_cast< double >( count ) * global_sum ) / ( static_cast< double >( global_count ) * sum ) );
+	}
+
+	/**
+	 * Rounds a divergence to the numerator of its fixed-point representation 
+	 * (clamping the negative rounding errors of a divergence of zero).
+	 */
+	static uint64_t round( const double divergence ) {
+		return divergence > 0 ? std::llround( divergence * KL_DENOMINATOR ) : 0;
+	}
+
+	static Rational distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+
+		double divergence = 0;
+		for( uint32_t i = 0; i < num_labels; ++i ) { divergence += term( counts[ i ], sum, global[ i ], global_sum ); }
+		return Rational{ round( divergence ), KL_DENOMINATOR };
+	}
+
+	static Rational deficiency_distance( uint32_t const* counts, const uint32_t sum, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels ) {
+		return distance( counts, sum, global, global_sum, num_labels );
+	}
+
+	/**
+	 * The logarithms are not vectorised by hand: the loop over the lanes 
+	 * of the block is left to the compiler.
+	 */
+	template < uint32_t fixed_labels >
+	static void block( uint32_t const* counts, uint32_t const* sums, 
+		uint32_t const* global, const uint32_t global_sum, const uint32_t num_labels, 
+		uint64_t *distances, uint64_t *differences, uint64_t *deficiencies ) {
+
+		const uint32_t length = ( fixed_labels > 0 ? fixed_labels : num_labels );
+		double divergences[ DISTANCE_BLOCK_SIZE ];
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) { divergences[ j ] = 0; deficiencies[ j ] = 0; }
+
+		for( uint32_t i = 0; i < length; ++i ) {
+			for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+				const uint32_t count = counts[ i * DISTANCE_BLOCK_SIZE + j ];
+				divergences[ j ] += term( count, sums[ j ], global[ i ], global_sum );
+				if( i < 64 && pairwise_difference( count, sums[ j ], global[ i ], global_sum ) < 0 ) {
+					deficiencies[ j ] |= UINT64_C( 1 ) << i;
+				}
+			}
+		}
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) { distances[ j ] = differences[ j ] = round( divergences[ j ] ); }
+	}
+};
+
+/**
+ * A pointer to a metric's distance() rule for a single neighbourhood.
+ */
+typedef Rational ( *MetricDistance )( uint32_t const*, const uint32_t, uint32_t const*, 
+	const uint32_t, const uint32_t );
+
+/**
+ * A pointer to one of the specialisations of a metric's block kernel.
+ */
+typedef void ( *DistanceKernel )( uint32_t const*, uint32_t const*, uint32_t const*, 
+	const uint32_t, const uint32_t, uint64_t*, uint64_t*, uint64_t* );
+
+/**
+ * Selects the fastest specialisation of a metric's block kernel for an 
+ * alphabet size.
+ * @tparam Metric The proximity metric.
+ * @param num_labels The alphabet size.
+ * @return The kernel specialised for num_labels if num_labels is at most 
+ * MAX_FIXED_LABELS, or else the one for alphabets of any size.
+ */
+template < class Metric >
+inline DistanceKernel select_distance_kernel( const uint32_t num_labels ) {
+	switch( num_labels ) {
+		case 1: return &Metric::template block< 1 >;
+		case 2: return &Metric::template block< 2 >;
+		case 3: return &Metric::template block< 3 >;
+		case 4: return &Metric::template block< 4 >;
+		case 5: return &Metric::template block< 5 >;
+		case 6: return &Metric::template block< 6 >;
+		case 7: return &Metric::template block< 7 >;
+		case 8: return &Metric::template block< 8 >;
+		default: return &Metric::template block< 0 >;
+	}
+}
+
+#endif /* DISTANCE_KERNELS_H_ */
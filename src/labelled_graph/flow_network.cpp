@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Implementation of the FlowNetwork class and its push-relabel solver.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstdint>		/* for uint32_t, uint64_t */
+#include <algorithm>	/* for std::min */
+#include <numeric>		/* for std::partial_sum() */
+
+/* STL stuff in use. */
+#include <vector>
+
+#include "flow_network.h" /* implementing this class. */
+
+FlowNetwork::FlowNetwork( const uint32_t num_nodes ) : num_nodes_( num_nodes ) { }
+
+uint32_t FlowNetwork::add_arc( const uint32_t from, const uint32_t to, const uint32_t capacity ) {
+	tail_.push_back( from );
+	head_.push_back( to );
+	residual_.push_back( capacity );
+	tail_.push_back( to );
+	head_.push_back( from );
+	residual_.push_back( 0 );
+	return residual_.size() / 2 - 1;
+}
+
+void FlowNetwork::global_relabel( const uint32_t source, const uint32_t sink ) {
+	const uint32_t unreached = 2 * num_nodes_;
+	height_.assign( num_nodes_, unreached );
+
+	/* Breadth-first search along reversed residual arcs, first from the sink and then, 
+	 * for the nodes that can only return their excess, from the source. */
+	std::vector< uint32_t > queue;
+	for( auto const root : { sink, source } ) {
+		height_[ root ] = ( root == sink ? 0 : num_nodes_ );
+		queue.assign( 1, root );
+		for( uint32_t i = 0; i < queue.size(); ++i ) {
+			const uint32_t w = queue[ i ];
+			for( uint32_t j = first_arc_[ w ]; j < first_arc_[ w + 1 ]; ++j ) {
+				const uint32_t v = head_[ out_arcs_[ j ] ];
+				if( height_[ v ] == unreached && residual_[ out_arcs_[ j ] ^ 1 ] > 0 ) {
+					height_[ v ] = height_[ w ] + 1;
+					queue.push_back( v );
+				}
+			}
+		}
+	}
+
+	height_count_.assign( 2 * num_nodes_ + 2, 0 );
+	for( uint32_t u = 0; u < num_nodes_; ++u ) { 
+		++height_count_[ height_[ u ] ]; 
+		current_arc_[ u ] = first_arc_[ u ];
+	}
+}
+
+uint32_t FlowNetwork::discharge( const uint32_t u, std::vector< uint32_t > *active, 
+	const uint32_t source, const uint32_t sink ) {
+
+	uint32_t num_relabels = 0;
+	while( excess_[ u ] > 0 ) {
+
+		/* Out of admissible arcs: relabel to one above the lowest residual neighbour. */
+		if( current_arc_[ u ] == first_arc_[ u + 1 ] ) {
+			const uint32_t old_height = height_[ u ];
+			uint32_t new_height = 2 * num_nodes_;
+			for( uint32_t j = first_arc_[ u ]; j < first_arc_[ u + 1 ]; ++j ) {
+				if( residual_[ out_arcs_[ j ] ] > 0 ) {
+					new_height = std::min( new_height, height_[ head_[ out_arcs_[ j ] ] ] + 1 );
+				}
+			}
+			--height_count_[ old_height ];
+			height_[ u ] = new_height;
+			++height_count_[ new_height ];
+			current_arc_[ u ] = first_arc_[ u ];
+			++num_relabels;
+
+			/* Gap: nodes above an empty height below num_nodes_ cannot reach the sink. */
+			if( height_count_[ old_height ] == 0 && old_height < num_nodes_ ) {
+				for( uint32_t v = 0; v < num_nodes_; ++v ) {
+					if( height_[ v ] > old_height && height_[ v ] < num_nodes_ ) {
+						--height_count_[ height_[ v ] ];
+						height_[ v ] = num_nodes_ + 1;
+						++height_count_[ height_[ v ] ];
+						current_arc_[ v ] = first_arc_[ v ];
+					}
+				}
+			}
+			continue;
+		}
+
+		const uint32_t arc = out_arcs_[ current_arc_[ u ] ];
+		const uint32_t v = head_[ arc ];
+		if( residual_[ arc ] > 0 && height_[ u ] == height_[ v ] + 1 ) {
+			const uint32_t delta = std::min< uint64_t >( excess_[ u ], residual_[ arc ] );
+			if( excess_[ v ] == 0 && v != source && v != sink ) { active->push_back( v ); }
+			residual_[ arc ] -= delta;
+			residual_[ arc ^ 1 ] += delta;
+			excess_[ u ] -= delta;
+			excess_[ v ] += delta;
+		}
+		else { ++current_arc_[ u ]; }
+	}
+	return num_relabels;
+}
+
+uint64_t FlowNetwork::max_flow( const uint32_t source, const uint32_t sink ) {
+	if( source == sink ) { return 0; }
+
+	/* Group the arcs by tail. */
+	first_arc_.assign( num_nodes_ + 1, 0 );
+	for( auto const u : tail_ ) { ++first_arc_[ u + 1 ]; }
+	std::partial_sum( first_arc_.begin(), first_arc_.end(), first_arc_.begin() );
+	out_arcs_.resize( tail_.size() );
+	current_arc_.assign( first_arc_.begin(), first_arc_.end() - 1 );
+	for( uint32_t arc = 0; arc < tail_.size(); ++arc ) { out_arcs_[ current_arc_[ tail_[ arc ] ]++ ] = arc; }
+
+	excess_.assign( num_nodes_, 0 );
+	global_relabel( source, sink );
+
+	/* Saturate the arcs out of the source. */
+	std::vector< uint32_t > active;
+	for( uint32_t j = first_arc_[ source ]; j < first_arc_[ source + 1 ]; ++j ) {
+		const uint32_t arc = out_arcs_[ j ], v = head_[ arc ];
+		const uint32_t delta = residual_[ arc ];
+		if( delta == 0 ) { continue; }
+		if( excess_[ v ] == 0 && v != sink && v != source ) { active.push_back( v ); }
+		residual_[ arc ] = 0;
+		residual_[ arc ^ 1 ] += delta;
+		excess_[ v ] += delta;
+	}
+
+	/* Discharge active nodes in FIFO order, periodically recomputing exact heights. */
+	uint32_t relabels_since_global = 0;
+	for( uint32_t i = 0; i < active.size(); ++i ) {
+		relabels_since_global += discharge( active[ i ], &active, source, sink );
+		if( relabels_since_global > num_nodes_ ) {
+			global_relabel( source, sink );
+			relabels_since_global = 0;
+		}
+	}
+	return excess_[ sink ];
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief Definition of a flow network with a push-relabel maximum-flow solver, 
+ * with which label deficiencies are matched as a b-matching.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FLOW_NETWORK_H_
+#define FLOW_NETWORK_H_
+
+#include <cstdint>	/* for uint32_t, uint64_t */
+
+/* STL libraries in use. */
+#include <vector>
+
+/**
+ * @brief A directed flow network with integral arc capacities whose maximum 
+ * flow is computed with the FIFO push-relabel algorithm of Goldberg and 
+ * Tarjan, with the global-relabelling and gap heuristics.
+ */
+class FlowNetwork {
+public:
+
+	/**
+	 * Constructs a flow network without arcs.
+	 * @param num_nodes The number of nodes, which are numbered from 0.
+	 */
+	FlowNetwork( const uint32_t num_nodes );
+
+	/**
+	 * Adds an arc (and its residual reverse arc) to the network.
+	 * @param from The tail of the arc.
+	 * @param to The head of the arc.
+	 * @param capacity The capacity of the arc.
+	 * @return The id of the arc, with which to query its flow.
+	 * @pre max_flow() has not been called yet.
+	 */
+	uint32_t add_arc( const uint32_t from, const uint32_t to, const uint32_t capacity );
+
+	/**
+	 * Computes a maximum flow from source to sink.
+	 * @param source The node from which flow originates.
+	 * @param sink The node at which flow terminates.
+	 * @return The value of the maximum flow.
+	 * @post get_flow() returns the flow on each arc.
+	 */
+	uint64_t max_flow( const uint32_t source, const uint32_t sink );
+
+	/**
+	 * Accessor method to return the flow on an arc after max_flow().
+	 * @param arc The id returned by add_arc().
+	 * @return The amount of flow that the arc carries.
+	 */
+	uint32_t get_flow( const uint32_t arc ) const { return residual_[ 2 * arc + 1 ]; }
+
+private:
+
+	/**
+	 * Sets the height of every node to its distance to the sink in the 
+	 * residual network or, if it cannot reach the sink, to num_nodes_ plus 
+	 * its distance to the source.
+	 * @param source The source of the flow.
+	 * @param sink The sink of the flow.
+	 */
+	void global_relabel( const uint32_t source, const uint32_t sink );
+
+	/**
+	 * Pushes excess out of node u along admissible arcs, relabelling u 
+	 * whenever it has none, until u has no excess left.
+	 * @param u The active node.
+	 * @param active The FIFO queue of active nodes, to which nodes that 
+	 * receive excess are appended.
+	 * @param source The source of the flow.
+	 * @param sink The sink of the flow.
+	 * @return The number of relabels that were performed.
+	 */
+	uint32_t discharge( const uint32_t u, std::vector< uint32_t > *active, 
+		const uint32_t source, const uint32_t sink );
+
+	uint32_t num_nodes_; /**< The number of nodes in the network. */
+	/**
+	 * The tail and head of each arc, where arc 2i is the i'th added arc and 
+	 * arc 2i + 1 its reverse.
+	 */
+	std::vector< uint32_t > tail_, head_;
+	std::vector< uint32_t > residual_; /**< The residual capacity of each arc. */
+	/**
+	 * The arcs out of node u are first_arc_[ u ] to first_arc_[ u + 1 ] - 1 
+	 * in out_arcs_, built by max_flow().
+	 */
+	std::vector< uint32_t > first_arc_, out_arcs_;
+	std::vector< uint32_t > height_; /**< The height label of each node. */
+	std::vector< uint64_t > excess_; /**< The excess flow at each node. */
+	std::vector< uint32_t > current_arc_; /**< The next arc of each node to try to push along. */
+	std::vector< uint32_t > height_count_; /**< The number of nodes at each height. */
+};
+
+#endif /* FLOW_NETWORK_H_ */
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief A set of functions for unit testing the FlowNetwork class.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint> /* for uint32_t */
+#include <vector>
+
+#include "flow_network.test.h"
+#include "flow_network.h"
+
+bool test_max_flow() {
+
+	bool passed = true;
+
+	/**
+	 * @test Textbook example
+	 * The network of Figure 26.1 in Cormen et al.'s Introduction to 
+	 * Algorithms (3rd ed.) has a maximum flow of 23. Every arc must carry 
+	 * at most its capacity, and flow must be conserved at every other node.
+	 */
+	const uint32_t tails[] = { 0, 0, 2, 1, 3, 2, 4, 3, 4 };
+	const uint32_t heads[] = { 1, 2, 1, 3, 2, 4, 3, 5, 5 };
+	const uint32_t capacities[] = { 16, 13, 4, 12, 9, 14, 7, 20, 4 };
+	FlowNetwork textbook( 6 );
+	for( uint32_t i = 0; i < 9; ++i ) { textbook.add_arc( tails[ i ], heads[ i ], capacities[ i ] ); }
+	if( textbook.max_flow( 0, 5 ) != 23 ) { passed = false; }
+	std::vector< int64_t > net_inflow( 6, 0 );
+	for( uint32_t i = 0; i < 9; ++i ) {
+		if( textbook.get_flow( i ) > capacities[ i ] ) { passed = false; }
+		net_inflow[ heads[ i ] ] += textbook.get_flow( i );
+		net_inflow[ tails[ i ] ] -= textbook.get_flow( i );
+	}
+	for( uint32_t u = 1; u < 5; ++u ) { if( net_inflow[ u ] != 0 ) { passed = false; } }
+	if( net_inflow[ 5 ] != 23 ) { passed = false; }
+
+	/**
+	 * @test Returning excess
+	 * All 10 units pushed out of the source into node 1 must be returned 
+	 * except the 1 that reaches the sink, including the 3 that first 
+	 * flow on into the dead end at node 2.
+	 */
+	FlowNetwork dead_end( 4 );
+	const uint32_t into_dead_end = dead_end.add_arc( 1, 2, 3 );
+	dead_end.add_arc( 0, 1, 10 );
+	const uint32_t to_sink = dead_end.add_arc( 1, 3, 1 );
+	if( dead_end.max_flow( 0, 3 ) != 1 || dead_end.get_flow( to_sink ) != 1 || 
+		dead_end.get_flow( into_dead_end ) != 0 ) { passed = false; }
+
+	/**
+	 * @test Unreachable sink
+	 * Without a path to the sink, the maximum flow is 0.
+	 */
+	FlowNetwork disconnected( 3 );
+	disconnected.add_arc( 0, 1, 5 );
+	disconnected.add_arc( 2, 1, 5 );
+	if( disconnected.max_flow( 0, 2 ) != 0 ) { passed = false; }
+
+	/**
+	 * @test b-matching
+	 * Sources a0, a1, a2 want 2, 1, and 2 mates and sinks b0, b1, b2 want 
+	 * 1, 2, and 1, with candidate pairs a0-b0, a0-b1, a1-b1, a2-b1, and 
+	 * a2-b2. The maximum b-matching has 4 pairs, since the sinks want only 
+	 * 4 mates, and the arcs with flow 1 must form such a b-matching.
+	 */
+	const uint32_t source_caps[] = { 2, 1, 2 }, sink_caps[] = { 1, 2, 1 };
+	const uint32_t mate_sources[] = { 0, 0, 1, 2, 2 }, mate_sinks[] = { 0, 1, 1, 1, 2 };
+	FlowNetwork b_matching( 8 ); /* source 0, sink 1, a's 2-4, and b's 5-7 */
+	for( uint32_t i = 0; i < 3; ++i ) {
+		b_matching.add_arc( 0, 2 + i, source_caps[ i ] );
+		b_matching.add_arc( 5 + i, 1, sink_caps[ i ] );
+	}
+	std::vector< uint32_t > mate_arcs;
+	for( uint32_t k = 0; k < 5; ++k ) { mate_arcs.push_back( b_matching.add_arc( 2 + mate_sources[ k ], 5 + mate_sinks[ k ], 1 ) ); }
+	if( b_matching.max_flow( 0, 1 ) != 4 ) { passed = false; }
+	std::vector< uint32_t > source_degrees( 3, 0 ), sink_degrees( 3, 0 );
+	uint32_t num_pairs = 0;
+	for( uint32_t k = 0; k < 5; ++k ) {
+		const uint32_t flow = b_matching.get_flow( mate_arcs[ k ] );
+		if( flow > 1 ) { passed = false; }
+		source_degrees[ mate_sources[ k ] ] += flow;
+		sink_degrees[ mate_sinks[ k ] ] += flow;
+		num_pairs += flow;
+	}
+	for( uint32_t i = 0; i < 3; ++i ) {
+		if( source_degrees[ i ] > source_caps[ i ] || sink_degrees[ i ] > sink_caps[ i ] ) { passed = false; }
+	}
+	if( num_pairs != 4 ) { passed = false; }
+
+	return passed;
+}
@@ -32,6 +32,7 @@
 
 #include <cstdint>	/* for uint32_t */
 #include <iostream>	/* for cout, endl */
+#include <cassert>	/* for assert */
 
 #include "label_distribution.h"
 
@@ -74,31 +75,28 @@ float LabelDistribution::distance( LabelDistribution *another ) {
 	return distance;
 }
 
-uint32_t LabelDistribution::get_deficiencies( LabelDistribution *another, const float alpha ) {
+LabelSet LabelDistribution::get_deficiencies( LabelDistribution *another, const float alpha ) {
 
-	/* cur_bit tracks the current bit of the bitmask (shifting left once
-	 * for each label/iteration. i keeps track of which label is currently
-	 * begin processed, and controls the number of iterations of the loop.
+	/* i keeps track of which label is currently begin processed, and 
+	 * controls the number of iterations of the loop.
 	 */
-	uint32_t deficiencies = 0;
+	const uint32_t num_labels = frequencies_.size();
+	LabelSet deficiencies( num_labels );
 	float difference = 0;
 
 	/* Iterate the set of labels, detecting deficiencies and scoring alpha-proximity */
-	const uint32_t num_labels = frequencies_.size();
-	for( uint32_t i = 0, cur_bit = 1; i < num_labels; ++i ) {
+	for( uint32_t i = 0; i < num_labels; ++i ) {
 
 		float pairwise_diff = another->get_frequency( i ) - get_frequency( i );
 		if( pairwise_diff > 0 ) {
-			/* the other has more, set bit and add to difference */
-			deficiencies |= cur_bit;
+			/* the other has more, add label and add to difference */
+			deficiencies.set( i );
 			difference += pairwise_diff;
 		}
 		else { difference -= pairwise_diff; } /* invert sign for absolute value difference */
-
-		cur_bit *= 2; /* shift current working bit in bitmask */
 	}
 
-	if( difference < alpha ) return 0; /* alpha-proximal */
+	if( difference < alpha ) return LabelSet( num_labels ); /* alpha-proximal */
 	else return deficiencies;
 }
 
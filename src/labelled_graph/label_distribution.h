@@ -34,9 +34,16 @@
 #ifndef LABEL_DISTRIBUTION_H_
 #define LABEL_DISTRIBUTION_H_
 
+#include <cstdint>	/* for uint32_t */
+#include <cassert>	/* for assert */
+
 /* STL libraries in use. */
 #include <vector>
 
+#include "label_set.h"
+#include "rational.h"
+#include "distance_kernels.h"
+
 /**
  * A sentinel value indicating that two LabelDistribution objects cannot
  * be compared to each other
@@ -85,6 +92,19 @@ public:
 	 */
 	float get_frequency( const uint32_t pos );
 
+	/**
+	 * Accessor method to return the absolute frequencies of all labels.
+	 * @return A pointer to get_length() counts, valid while this
+	 * LabelDistribution exists.
+	 */
+	uint32_t const* get_counts() const { return frequencies_.data(); }
+
+	/**
+	 * Accessor method to return the sum of all absolute frequencies.
+	 * @return The sum of the counts returned by get_counts().
+	 */
+	uint32_t get_sum() const { return sum_; }
+
 	/**
 	 * Calculates the distance from this LabelDistribution to another.
 	 * @param another The other LabelDistribution against which the distance
@@ -102,19 +122,54 @@ public:
 	 * @param another The reference LabelDistribution (typically the global
 	 * distribution)
 	 * @param alpha The privacy threshold
-	 * @return A bitmask indicating the deficient labels, if the vertex does not
+	 * @return The set of deficient labels, if the vertex does not
 	 * already have an alpha-proximal neighbourhood. (If the neighbourhood is alpha-
-	 * proximal, then 0/no deficiencies ire returned.) If the i'th bit
-	 * (counting from the rightmost, least significant bit)
-	 * is set in the bitmask, then another has a higher relative frequency
+	 * proximal, then an empty set/no deficiencies are returned.) If the i'th 
+	 * label is in the set, then another has a higher relative frequency
 	 * of the i'th label than does this LabelDistribution.
-	 * @warning Assumes the alphabet size for the set of labels is <= 32,
-	 * because the bitmask returned is a 32-bit unsigned integer. For larger
-	 * alphabets, a new implementation is needed.
 	 * @warning Behaviour is undefined if this LabelDistribution and another
 	 * have different lengths
 	 */
-	uint32_t get_deficiencies( LabelDistribution *another, const float alpha );
+	LabelSet get_deficiencies( LabelDistribution *another, const float alpha );
+
+	/**
+	 * Calculates exactly the distance from this LabelDistribution to the one 
+	 * given by raw label counts, without constructing a LabelDistribution for 
+	 * them. The relative frequencies are compared by cross-multiplying the 
+	 * counts with the sums in 64-bit integers, so no rounding occurs (except 
+	 * for the irrational KLDivergence).
+	 * @tparam Metric The proximity metric, e.g., L1Distance or 
+	 * EarthMoversDistance, from distance_kernels.h.
+	 * @param counts The absolute frequency of each label, of which there must 
+	 * be get_length().
+	 * @param sum The sum of the counts, which must be positive, as must the 
+	 * sum of this LabelDistribution.
+	 * @return By default, the distance of Definition 2.4 in @cite asonam , as 
+	 * computed approximately by distance().
+	 * @see distance()
+	 */
+	template < class Metric = L1Distance >
+	Rational distance( uint32_t const* counts, const uint32_t sum ) const;
+
+	/**
+	 * Determines exactly in which labels the distribution given by raw label 
+	 * counts is lacking relative to this LabelDistribution, without 
+	 * constructing a LabelDistribution for them.
+	 * @param counts The absolute frequency of each label, of which there must 
+	 * be get_length().
+	 * @param sum The sum of the counts, which must be positive, as must the 
+	 * sum of this LabelDistribution.
+	 * @param alpha The privacy threshold
+	 * @tparam Metric The proximity metric whose deficiency_distance() decides 
+	 * whether the neighbourhood is deficient at all.
+	 * @return By default, the LabelSet that get_deficiencies() approximates 
+	 * when invoked on a LabelDistribution constructed from counts, with this 
+	 * one as another.
+	 * @see get_deficiencies()
+	 */
+	template < class Metric = L1Distance >
+	LabelSet get_deficiencies_of( uint32_t const* counts, const uint32_t sum, 
+		Rational const& alpha ) const;
 
 	/**
 	 * Echoes the LabelDistribution to stdout. Primarily for the purpose
@@ -135,4 +190,29 @@ private:
 	uint32_t sum_;
 };
 
+template < class Metric >
+Rational LabelDistribution::distance( uint32_t const* counts, const uint32_t sum ) const {
+	assert( sum > 0 && sum_ > 0 );
+	return Metric::distance( counts, sum, frequencies_.data(), sum_, frequencies_.size() );
+}
+
+template < class Metric >
+LabelSet LabelDistribution::get_deficiencies_of( uint32_t const* counts, 
+	const uint32_t sum, Rational const& alpha ) const {
+	assert( sum > 0 && sum_ > 0 );
+
+	const uint32_t num_labels = frequencies_.size();
+	LabelSet deficiencies( num_labels );
+	if( Metric::deficiency_distance( counts, sum, frequencies_.data(), sum_, num_labels ) < alpha ) { 
+		return deficiencies; /* alpha-proximal */
+	}
+
+	/* Same iteration as get_deficiencies(), with this as the reference distribution, 
+	 * on the numerators over the common denominator sum * sum_. */
+	for( uint32_t i = 0; i < num_labels; ++i ) {
+		if( pairwise_difference( counts[ i ], sum, frequencies_[ i ], sum_ ) < 0 ) { deficiencies.set( i ); }
+	}
+	return deficiencies;
+}
+
 #endif /* LABEL_DISTRIBUTION_H_ */
@@ -37,6 +37,44 @@
 
 #include "label_distribution.test.h"
 #include "label_distribution.h"
+#include "distance_kernels.h"
+
+/**
+ * Checks that the block kernels of a metric (both the one specialised for 
+ * three labels and the generic one) agree with its rules for one 
+ * neighbourhood at a time.
+ * @param global The global LabelDistribution, of three labels.
+ * @param block_counts The label counts of a block of neighbourhoods, in 
+ * structure-of-arrays layout.
+ * @param block_sums The sum of the counts of each neighbourhood.
+ * @return True if all distances and deficiencies are the same.
+ */
+template < class Metric >
+static bool kernels_agree( LabelDistribution const* global, std::vector< uint32_t > const& block_counts, 
+	uint32_t const* block_sums ) {
+
+	bool agree = true;
+	Rational zero{ 0, 1 };
+	for( DistanceKernel kernel : { select_distance_kernel< Metric >( 3 ), &Metric::template block< 0 > } ) {
+		uint64_t distances[ DISTANCE_BLOCK_SIZE ], differences[ DISTANCE_BLOCK_SIZE ], masks[ DISTANCE_BLOCK_SIZE ];
+		kernel( block_counts.data(), block_sums, global->get_counts(), global->get_sum(), 3, 
+			distances, differences, masks );
+		for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+			std::vector< uint32_t > const counts { block_counts[ j ], block_counts[ DISTANCE_BLOCK_SIZE + j ], 
+				block_counts[ 2 * DISTANCE_BLOCK_SIZE + j ] };
+			const uint64_t denominator = Metric::denominator( block_sums[ j ], global->get_sum(), 3 );
+			if( !( Rational{ distances[ j ], denominator } == 
+				global->distance< Metric >( counts.data(), block_sums[ j ] ) ) ) { agree = false; }
+			if( !( Rational{ differences[ j ], denominator } == Metric::deficiency_distance( counts.data(), 
+				block_sums[ j ], global->get_counts(), global->get_sum(), 3 ) ) ) { agree = false; }
+			LabelSet lacking = global->get_deficiencies_of< Metric >( counts.data(), block_sums[ j ], zero );
+			for( uint32_t i = 0; i < 3; ++i ) {
+				if( lacking.test( i ) != ( ( masks[ j ] >> i ) & 1 ) ) { agree = false; }
+			}
+		}
+	}
+	return agree;
+}
 
 bool test_distance() {
 
@@ -85,6 +123,57 @@ bool test_distance() {
 	delete l2;
 	delete l1;
 
+	/**
+	 * @test Exactness on raw counts
+	 * Comparing against raw label counts, as is done with the neighbourhood 
+	 * label-count matrix, is exact: the distance in the example from the paper 
+	 * is exactly 7/10, which is within alpha = 0.7 but not within any smaller 
+	 * alpha, and the deficiencies agree with the approximate ones.
+	 */
+	Rational alpha;
+	l1 = new LabelDistribution( &l1_counts );
+	l2 = new LabelDistribution( &l2_counts );
+	if( !( l1->distance( l2_counts.data(), 10 ) == Rational{ 7, 10 } ) ) { passed = false; }
+	if( !Rational::parse( "0.7", &alpha ) || !( l1->distance( l2_counts.data(), 10 ) <= alpha ) ) { passed = false; }
+	if( !Rational::parse( "0.699999999", &alpha ) || l1->distance( l2_counts.data(), 10 ) <= alpha ) { passed = false; }
+	if( !Rational::parse( "1/2", &alpha ) || !( l2->get_deficiencies( l1, 0.5 ) == 
+		l1->get_deficiencies_of( l2_counts.data(), 10, alpha ) ) ) { passed = false; }
+	if( !l2->get_deficiencies( l1, 0.5 ).any() ) { passed = false; }
+	delete l2;
+	delete l1;
+
+	/**
+	 * @test Other metrics
+	 * For the example from the paper, the ordinal Earth Mover's Distance is 
+	 * ( 0.5 + 0.3 ) / 2, the max-norm distance is 0.5, and the KL divergence 
+	 * of <0.2, 0.4, 0.4> from <0.7, 0.2, 0.1> is about 0.5812.
+	 */
+	l1 = new LabelDistribution( &l1_counts );
+	if( !( l1->distance< EarthMoversDistance >( l2_counts.data(), 10 ) == Rational{ 2, 5 } ) ) { passed = false; }
+	if( !( l1->distance< MaxNormDistance >( l2_counts.data(), 10 ) == Rational{ 1, 2 } ) ) { passed = false; }
+	if( !( l1->distance< KLDivergence >( l2_counts.data(), 10 ) > Rational{ 5811, 10000 } ) || 
+		!( l1->distance< KLDivergence >( l2_counts.data(), 10 ) < Rational{ 5813, 10000 } ) ) { passed = false; }
+	if( !( l1->distance< KLDivergence >( l1_counts.data(), 10 ) == Rational{ 0, 1 } ) ) { passed = false; }
+
+	/**
+	 * @test Batch kernels
+	 * The block kernels of every metric, whether specialised for three labels 
+	 * or not, agree exactly with the distances and deficiencies computed for 
+	 * one neighbourhood at a time, for a block of varied neighbourhoods of the 
+	 * example from the paper.
+	 */
+	std::vector< uint32_t > block_counts( 3 * DISTANCE_BLOCK_SIZE );
+	uint32_t block_sums[ DISTANCE_BLOCK_SIZE ];
+	for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+		for( uint32_t i = 0; i < 3; ++i ) { block_counts[ i * DISTANCE_BLOCK_SIZE + j ] = ( j * ( 2 * i + 3 ) + i ) % 11; }
+		block_sums[ j ] = block_counts[ j ] + block_counts[ DISTANCE_BLOCK_SIZE + j ] 
+			+ block_counts[ 2 * DISTANCE_BLOCK_SIZE + j ];
+	}
+	if( !kernels_agree< L1Distance >( l1, block_counts, block_sums ) ) { passed = false; }
+	if( !kernels_agree< EarthMoversDistance >( l1, block_counts, block_sums ) ) { passed = false; }
+	if( !kernels_agree< MaxNormDistance >( l1, block_counts, block_sums ) ) { passed = false; }
+	if( !kernels_agree< KLDivergence >( l1, block_counts, block_sums ) ) { passed = false; }
+	delete l1;
 
 	return passed;
 }
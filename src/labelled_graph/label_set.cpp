@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Implementation of the LabelSet class in label_set.h
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>		/* for uint32_t, uint64_t */
+
+#ifdef __AVX2__
+#include <immintrin.h>	/* for AVX2 intrinsics */
+#endif
+
+/* STL stuff in use. */
+#include <vector>
+
+#include "label_set.h" /* implementing this class. */
+
+uint32_t LabelSet::count() const {
+	if( words_.empty() ) { return __builtin_popcountll( word_ ); }
+
+	uint32_t count = 0;
+	for( auto const word : words_ ) { count += __builtin_popcountll( word ); }
+	return count;
+}
+
+uint32_t LabelSet::find_next( const uint32_t l ) const {
+	uint64_t const *words = data();
+	const uint32_t num_words = ( words_.empty() ? 1 : words_.size() );
+
+	uint32_t w = l / 64;
+	if( w >= num_words ) { return NO_LABEL; }
+
+	/* Mask off the labels below l in the first word, then skip empty words. */
+	uint64_t word = words[ w ] & ( ~UINT64_C( 0 ) << ( l % 64 ) );
+	while( word == 0 ) {
+		if( ++w == num_words ) { return NO_LABEL; }
+		word = words[ w ];
+	}
+	return w * 64 + __builtin_ctzll( word );
+}
+
+bool LabelSet::any_of_words() const {
+	uint32_t w = 0;
+
+#ifdef __AVX2__
+	/* Test four words at a time. */
+	for( ; w + 4 <= words_.size(); w += 4 ) {
+		const __m256i block = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( words_.data() + w ) );
+		if( !_mm256_testz_si256( block, block ) ) { return true; }
+	}
+#endif
+
+	for( ; w < words_.size(); ++w ) {
+		if( words_[ w ] != 0 ) { return true; }
+	}
+	return false;
+}
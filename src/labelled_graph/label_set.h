@@ -0,0 +1,135 @@
+/**
+ * @file
+ * @brief Definition of a set of vertex labels, such as the labels in which a 
+ * neighbourhood is deficient, for label alphabets of any size.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LABEL_SET_H_
+#define LABEL_SET_H_
+
+#include <cstdint>	/* for uint32_t, uint64_t, UINT32_MAX */
+
+/* STL libraries in use. */
+#include <vector>
+
+/**
+ * A sentinel value returned when searching a LabelSet for a label that 
+ * it does not contain.
+ */
+#define NO_LABEL UINT32_MAX
+
+/**
+ * @brief A dynamically-sized bitset over a label alphabet, in which the 
+ * i'th bit indicates membership of the i'th label.
+ * 
+ * Alphabets of at most 64 labels are stored in a single word within the 
+ * object itself, so that, as with a plain bitmask, no memory is allocated 
+ * and every operation is a single word operation. Larger alphabets are 
+ * stored in a vector of words and scanned with AVX2 when available.
+ */
+class LabelSet {
+public:
+
+	/**
+	 * Constructs an empty LabelSet.
+	 * @param num_labels The size of the label alphabet.
+	 */
+	explicit LabelSet( const uint32_t num_labels = 0 ) : word_( 0 ) {
+		if( num_labels > 64 ) { words_.assign( ( num_labels + 63 ) / 64, 0 ); }
+	}
+
+	/**
+	 * Adds label l to the LabelSet.
+	 * @param l The label to add.
+	 */
+	void set( const uint32_t l ) { data()[ l / 64 ] |= UINT64_C( 1 ) << ( l % 64 ); }
+
+	/**
+	 * Removes label l from the LabelSet.
+	 * @param l The label to remove.
+	 */
+	void reset( const uint32_t l ) { data()[ l / 64 ] &= ~( UINT64_C( 1 ) << ( l % 64 ) ); }
+
+	/**
+	 * Determines whether label l is in the LabelSet.
+	 * @param l The label to look up.
+	 * @return True if l is in the LabelSet.
+	 */
+	bool test( const uint32_t l ) const { return ( data()[ l / 64 ] >> ( l % 64 ) ) & 1; }
+
+	/**
+	 * Determines whether the LabelSet contains any label at all.
+	 * @return True if the LabelSet is non-empty.
+	 */
+	bool any() const { return words_.empty() ? word_ != 0 : any_of_words(); }
+
+	/**
+	 * Counts the labels in the LabelSet.
+	 * @return The number of labels in the LabelSet.
+	 */
+	uint32_t count() const;
+
+	/**
+	 * Returns the smallest label in the LabelSet that is at least l.
+	 * @param l The label from which to search.
+	 * @return The smallest label in the LabelSet that is at least l, or 
+	 * NO_LABEL if there is none.
+	 */
+	uint32_t find_next( const uint32_t l ) const;
+
+	/**
+	 * Returns the smallest label in the LabelSet.
+	 * @return The smallest label in the LabelSet, or NO_LABEL if it is empty.
+	 */
+	uint32_t find_first() const { return find_next( 0 ); }
+
+	/**
+	 * Compares two LabelSets over the same alphabet.
+	 * @param other The LabelSet to compare against.
+	 * @return True if both LabelSets contain exactly the same labels.
+	 */
+	bool operator==( LabelSet const& other ) const { 
+		return word_ == other.word_ && words_ == other.words_; 
+	}
+
+private:
+	/**
+	 * Accessor methods for the words of the bitset, wherever they are stored.
+	 */
+	uint64_t *data() { return words_.empty() ? &word_ : words_.data(); }
+	uint64_t const *data() const { return words_.empty() ? &word_ : words_.data(); }
+
+	/**
+	 * Determines whether any bit of a multi-word LabelSet is set.
+	 * @return True if the LabelSet is non-empty.
+	 */
+	bool any_of_words() const;
+
+	uint64_t word_; /**< The bitset, if there are at most 64 labels. */
+	std::vector< uint64_t > words_; /**< The bitset, if there are more than 64 labels. */
+};
+
+#endif /* LABEL_SET_H_ */
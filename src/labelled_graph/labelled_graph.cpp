@@ -31,55 +31,129 @@
  */
 
 #include <cstdint>		/* for uint32_t */
-#include <algorithm>	/* for random_shuffle */
+#include <algorithm>	/* for random_shuffle, std::min, std::sort, std::unique */
 #include <iostream>		/* for cout, endl */
 #include <cstdlib>		/* for srand, rand */
 #include <cstring>		/* for ffs and std::string */
 #include <fstream>		/* for ifstream, infile */
 #include <sstream>		/* for istringstream, getline */
 
+#include <numeric>		/* for std::partial_sum(), std::iota() */
+#include <random>		/* for std::mt19937, std::seed_seq */
+#include <omp.h>		/* for omp_get_wtime() */
+
 /* STL stuff in use. */
 #include <vector>
 #include <unordered_set>
 
 #include "labelled_graph.h" /* implementing this class. */
 
+/**
+ * Randomly permutes a vector in parallel, such that every permutation is 
+ * equally likely. Each element is first scattered to a bucket chosen 
+ * uniformly at random, and then each bucket is shuffled with Fisher-Yates, 
+ * both in parallel over blocks of LABEL_SHUFFLE_BLOCK_SIZE elements.
+ * @param values The vector to permute.
+ * @param seed The seed from which each block's random number generator is 
+ * derived, so that the permutation does not depend on the number of threads.
+ */
+static void parallel_shuffle( std::vector< uint32_t > *values, const uint32_t seed ) {
+	const uint32_t n = values->size();
+	const uint32_t num_blocks = ( n + LABEL_SHUFFLE_BLOCK_SIZE - 1 ) / LABEL_SHUFFLE_BLOCK_SIZE;
+	if( num_blocks == 0 ) { return; }
+
+	/* Choose a bucket for every element and count the choices per block. */
+	std::vector< uint32_t > buckets( n );
+	std::vector< uint32_t > offsets( static_cast< size_t >( num_blocks ) * num_blocks, 0 );
+#pragma omp parallel for schedule( static )
+	for( uint32_t b = 0; b < num_blocks; ++b ) {
+		std::seed_seq block_seed{ seed, b };
+		std::mt19937 gen( block_seed );
+		std::uniform_int_distribution< uint32_t > pick( 0, num_blocks - 1 );
+		const uint32_t end = std::min< uint64_t >( n, static_cast< uint64_t >( b + 1 ) * LABEL_SHUFFLE_BLOCK_SIZE );
+		for( uint32_t i = b * LABEL_SHUFFLE_BLOCK_SIZE; i < end; ++i ) {
+			buckets[ i ] = pick( gen );
+			++offsets[ static_cast< size_t >( buckets[ i ] ) * num_blocks + b ];
+		}
+	}
+
+	/* Bucket-major prefix sum: where each block writes into each bucket. */
+	std::vector< uint32_t > bucket_start( num_blocks + 1, 0 );
+	uint32_t total = 0;
+	for( uint32_t k = 0; k < num_blocks; ++k ) {
+		bucket_start[ k ] = total;
+		for( uint32_t b = 0; b < num_blocks; ++b ) {
+			const uint32_t count = offsets[ static_cast< size_t >( k ) * num_blocks + b ];
+			offsets[ static_cast< size_t >( k ) * num_blocks + b ] = total;
+			total += count;
+		}
+	}
+	bucket_start[ num_blocks ] = total;
+
+	std::vector< uint32_t > scattered( n );
+#pragma omp parallel for schedule( static )
+	for( uint32_t b = 0; b < num_blocks; ++b ) {
+		const uint32_t end = std::min< uint64_t >( n, static_cast< uint64_t >( b + 1 ) * LABEL_SHUFFLE_BLOCK_SIZE );
+		for( uint32_t i = b * LABEL_SHUFFLE_BLOCK_SIZE; i < end; ++i ) {
+			scattered[ offsets[ static_cast< size_t >( buckets[ i ] ) * num_blocks + b ]++ ] = ( *values )[ i ];
+		}
+	}
+
+	/* Finally, shuffle each bucket independently. */
+#pragma omp parallel for schedule( dynamic, 1 )
+	for( uint32_t k = 0; k < num_blocks; ++k ) {
+		std::seed_seq bucket_seed{ seed, num_blocks + k };
+		std::mt19937 gen( bucket_seed );
+		for( uint32_t i = bucket_start[ k + 1 ]; i > bucket_start[ k ] + 1; --i ) {
+			std::uniform_int_distribution< uint32_t > pick( bucket_start[ k ], i - 1 );
+			std::swap( scattered[ i - 1 ], scattered[ pick( gen ) ] );
+		}
+	}
+	*values = std::move( scattered );
+}
+
 void LabelledGraph::init() {
 	/* Initialize adjacency list with n_ empty vectors and every vertex
-	 * to have the same label. */
+	 * to have the same label for every attribute. */
 	adjacency_list_.reserve( n_ );
 	for( uint32_t i = 0; i < n_ ; ++i ) {
 		adjacency_list_.push_back( std::unordered_set< uint32_t >() );
-		vertex_labels_.push_back ( 0 );
 	}
+	vertex_labels_.assign( alphabet_sizes_.size(), std::vector< uint32_t >( n_, 0 ) );
 
 	/* Originally, there are no edges yet (every vertex is  isolated). */
 	m_ = 0;
+	count_neighbourhood_labels();
 
 	/* initialize random seed for generating random edges later */
 	srand (time(NULL));
 }
 
 LabelledGraph::LabelledGraph( const uint32_t num_vertices, const uint32_t num_labels ) :
-	UnlabelledGraph( num_vertices ), l_ ( num_labels ) { init(); }
+	UnlabelledGraph( num_vertices ), alphabet_sizes_ ( 1, num_labels ) { init(); }
+
+LabelledGraph::LabelledGraph( const uint32_t num_vertices, std::vector< uint32_t > const& alphabet_sizes ) :
+	UnlabelledGraph( num_vertices ), alphabet_sizes_ ( alphabet_sizes ) { init(); }
 
 LabelledGraph::LabelledGraph( const std::string filename ) {
 	std::string line;
 	std::cout << filename << std::endl;
 	std::ifstream infile( filename );
 
-	/* first parse the graph and label alphabet sizes from
-	 * the first line of the file
+	/* first parse the graph and label alphabet sizes (one per attribute) 
+	 * from the first line of the file
 	 */
 	std::getline( infile, line );
 	std::istringstream iss( line );
-	iss >> n_ >> l_;
+	iss >> n_;
+	uint32_t num_labels;
+	while( iss >> num_labels ) { alphabet_sizes_.push_back( num_labels ); }
 
 	/* check whether n_ was at least read correctly -- the only real
 	 * error checking done in this constructor.
 	 */
-	if( n_ <= 0 ) {
-		std::cerr << "Did not parse a positive number of vertices from input file. "
+	if( n_ <= 0 || alphabet_sizes_.empty() ) {
+		std::cerr << "Did not parse a positive number of vertices and labels from input file. "
 				<< "Did you format the file correctly and specify the correct path?"
 				<< std::endl;
 		return;
@@ -102,64 +176,111 @@ LabelledGraph::LabelledGraph( const std::string filename ) {
 		std::getline( infile, line );
 		std::istringstream iss( line );
 
-		/* set label to be first character */
-		iss >> vertex_labels_[ u ];
+		/* set labels to be the first characters, one per attribute */
+		for( auto &labels : vertex_labels_ ) { iss >> labels[ u ]; }
 
 		/* all other numbers on the adjacency list line
 		 * neighbours of u: add them to u's adjacency list.
 		 * Note: undirected graph, so also reciprocally adds
-		 * (v, u), even if that isn't in the input file
+		 * (v, u), even if that isn't in the input file. Not all labels are 
+		 * known yet, so the label counts are only computed afterwards.
 		 */
 		uint32_t v;
-		while( iss >> v ) { add_edge( u, v ); }
+		while( iss >> v ) { UnlabelledGraph::add_edge( u, v ); }
 	}
+	count_neighbourhood_labels();
 }
 
-LabelledGraph::~LabelledGraph() {}
+LabelledGraph::LabelledGraph( LabelledGraph const* other ) : UnlabelledGraph( *other ), 
+	vertex_labels_( other->vertex_labels_ ), alphabet_sizes_( other->alphabet_sizes_ ), 
+	neighbourhood_label_counts_( other->neighbourhood_label_counts_ ) { }
 
-void LabelledGraph::evenly_distribute_labels() {
-	const uint32_t vertices_per_label = n_ / l_;
-	uint32_t labels_left = n_ - vertices_per_label;
+LabelledGraph::~LabelledGraph() { untrack_alpha_proximity(); }
 
-	/* Starts with all labels set to 0. Iterates in total all but vertices_per_label times, plus
-	 * the remainder from the division. When iteration is done, label 0 is left with only
-	 * vertices_per_label plus the remainder vertices left.
-	 */
-	for( uint32_t cur_label = 1; cur_label < l_; ++cur_label ) {
-		for( uint32_t num_assigned = 0; num_assigned < vertices_per_label; ++num_assigned ) {
-			const uint32_t v = rand() % n_;
-			if( vertex_labels_[ v ] == 0 ) { vertex_labels_[ v ] = cur_label; }
-			else { --num_assigned; }
+LabelledGraph* LabelledGraph::clone() const { return new LabelledGraph( this ); }
+
+void LabelledGraph::evenly_distribute_labels( const uint32_t seed ) {
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		const uint32_t l = alphabet_sizes_[ attribute ];
+		const uint32_t vertices_per_label = n_ / l;
+		const uint32_t num_balanced = vertices_per_label * l;
+		std::mt19937 gen( seed + attribute );
+
+		/* Every label appears vertices_per_label times, and the remainder 
+		 * from the division goes to distinct labels chosen by a partial 
+		 * Fisher-Yates shuffle of the alphabet. 
+		 */
+		std::vector< uint32_t > labels( n_ );
+#pragma omp parallel for schedule( static )
+		for( uint32_t v = 0; v < num_balanced; ++v ) { labels[ v ] = v % l; }
+
+		std::vector< uint32_t > alphabet( l );
+		std::iota( alphabet.begin(), alphabet.end(), 0 );
+		for( uint32_t i = 0; i < n_ - num_balanced; ++i ) {
+			std::uniform_int_distribution< uint32_t > pick( i, l - 1 );
+			std::swap( alphabet[ i ], alphabet[ pick( gen ) ] );
+			labels[ num_balanced + i ] = alphabet[ i ];
 		}
-		labels_left -= vertices_per_label;
+
+		/* Then the labels are dealt to the vertices by a random permutation. */
+		parallel_shuffle( &labels, gen() );
+		vertex_labels_[ attribute ] = std::move( labels );
 	}
+	count_neighbourhood_labels();
+}
 
-	/* The remainder is then distributed with a random permutation. */
-	if( labels_left > 0 ) {
-		std::unordered_set< uint32_t > s;
-		while( labels_left > 0 ) {
-			const uint32_t v = rand() % n_;
-			if( vertex_labels_[ v ] == 0 ) {
-				uint32_t l = rand() % l_;
-				while( s.count( l ) > 0 ) {
-					l = rand() % l_;
-				}
-				s.insert( l );
-				vertex_labels_[ v ] = l;
-				--labels_left;
-			}
-			else {
-				/* with equal probability, keep it 0. */
-				if( rand() % l_ == 0 ) { --labels_left; }
-			}
+void LabelledGraph::count_neighbourhood_labels() {
+	/* The tracked distances are stale once the labels change. */
+	untrack_alpha_proximity();
+	neighbourhood_label_counts_.resize( alphabet_sizes_.size() );
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		neighbourhood_label_counts_[ attribute ].assign( static_cast< size_t >( n_ ) * alphabet_sizes_[ attribute ], 0 );
+	}
+
+#pragma omp parallel for schedule( dynamic, 256 )
+	for( uint32_t v = 0; v < n_; ++v ) {
+		for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+			std::vector< uint32_t > const& labels = vertex_labels_[ attribute ];
+			uint32_t *counts = neighbourhood_label_counts_[ attribute ].data() 
+				+ static_cast< size_t >( v ) * alphabet_sizes_[ attribute ];
+			++counts[ labels[ v ] ];
+			for( auto const u : adjacency_list_[ v ] ) { ++counts[ labels[ u ] ]; }
 		}
 	}
 }
 
+bool LabelledGraph::add_edge( const uint32_t u, const uint32_t v ) {
+	if( !UnlabelledGraph::add_edge( u, v ) ) { return false; }
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		const uint32_t l = alphabet_sizes_[ attribute ];
+		++neighbourhood_label_counts_[ attribute ][ static_cast< size_t >( u ) * l + vertex_labels_[ attribute ][ v ] ];
+		++neighbourhood_label_counts_[ attribute ][ static_cast< size_t >( v ) * l + vertex_labels_[ attribute ][ u ] ];
+	}
+	if( tracker_ != NULL ) {
+		tracker_->update( u, tracked_distance( u ) );
+		tracker_->update( v, tracked_distance( v ) );
+	}
+	return true;
+}
+
+Rational LabelledGraph::tracked_distance( const uint32_t v ) const {
+	const uint32_t sum = adjacency_list_[ v ].size() + 1;
+	Rational max_distance{ 0, 1 };
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		LabelDistribution const* global = tracked_global_lds_[ attribute ];
+		const Rational distance = tracked_metric_( get_neighbourhood_counts( attribute, v ), sum, 
+			global->get_counts(), global->get_sum(), alphabet_sizes_[ attribute ] );
+		if( distance > max_distance ) { max_distance = distance; }
+	}
+	return max_distance;
+}
+
 void LabelledGraph::print( std::ofstream *outstream ) {
-	(*outstream) << n_ << " " << l_ << std::endl;
+	(*outstream) << n_;
+	for( auto const l : alphabet_sizes_ ) { (*outstream) << " " << l; }
+	(*outstream) << std::endl;
 	for( uint32_t i = 0; i < n_; ++i ) {
-		(*outstream) << vertex_labels_[ i ] << " ";
+		for( auto const& labels : vertex_labels_ ) { (*outstream) << labels[ i ] << " "; }
 		for( auto it = adjacency_list_[i].begin(); it != adjacency_list_[i].end(); ++it ) {
 			(*outstream) << *it << " ";
 		}
@@ -167,16 +288,16 @@ void LabelledGraph::print( std::ofstream *outstream ) {
 	}
 }
 
-void inline LabelledGraph::get_global_ld( LabelDistribution **ld ) {
+void LabelledGraph::get_global_ld( const uint32_t attribute, LabelDistribution **ld ) {
 
 	/* Initialize an empty solution. */
 	std::vector< uint32_t > counts;
-	for( uint32_t i = 0; i < l_; ++i ) { counts.push_back( 0 ); }
+	for( uint32_t i = 0; i < alphabet_sizes_[ attribute ]; ++i ) { counts.push_back( 0 ); }
 
 	/* Iterate vertices, incrementing the relative label frequency
 	 * counts for each one.
 	 */
-	for( auto it = vertex_labels_.begin(); it != vertex_labels_.end(); ++it ) {
+	for( auto it = vertex_labels_[ attribute ].begin(); it != vertex_labels_[ attribute ].end(); ++it ) {
 		++counts[ *it ];
 	}
 
@@ -184,128 +305,251 @@ void inline LabelledGraph::get_global_ld( LabelDistribution **ld ) {
 	*ld = new LabelDistribution( &counts );
 }
 
-void inline LabelledGraph::get_neighbourhood_ld( LabelDistribution **ld, 
-	const uint32_t v ) {
-
-	/* Initialize an empty solution. */
-	std::vector< uint32_t > counts;
-	for( uint32_t i = 0; i < l_; ++i ) { counts.push_back( 0 ); }
-
-	/* Increment count for v's label. */
-	++counts[ vertex_labels_[ v ] ];
-
-	/* Iterate neighbours of v, incrementing the relative label frequency
-	 * counts for each one.
-	 */
-	for( auto it = adjacency_list_[ v ].begin(); it != adjacency_list_[ v ].end(); ++it ) {
-		++counts[ vertex_labels_[ *it ] ];
-	}
-
-	/* Create new LabelDistribuion from he counts vector. */
-	*ld = new LabelDistribution( &counts );
+void LabelledGraph::untrack_alpha_proximity() {
+	delete tracker_;
+	for( auto global : tracked_global_lds_ ) { delete global; }
+	tracker_ = NULL;
+	tracked_metric_ = NULL;
+	tracked_global_lds_.clear();
 }
 
-bool LabelledGraph::is_alpha_proximal( const float alpha ) {
-	LabelDistribution *global, *neighbourhood;
-	float max_distance = 0;
-
-	get_global_ld( &global );
+double LabelledGraph::log_timestamp() const { return convergence_log_ != NULL ? omp_get_wtime() : 0; }
+
+void LabelledGraph::log_iteration( Rational const& alpha, const uint32_t iteration, const uint32_t new_edges, 
+	const uint32_t fallback_edges, double const* timestamps ) const {
+
+	if( convergence_log_ == NULL ) { return; }
+	IterationRecord record;
+	record.alpha = alpha.numerator / static_cast< double >( alpha.denominator );
+	record.iteration = iteration;
+	record.new_edges = new_edges;
+	record.fallback_edges = fallback_edges;
+	record.num_deficient = tracker_->num_deficient();
+	record.max_distance = tracker_->max_distance().numerator / static_cast< double >( tracker_->max_distance().denominator );
+	record.mean_distance = tracker_->mean_distance();
+	record.step_seconds = timestamps[ 1 ] - timestamps[ 0 ];
+	record.check_seconds = timestamps[ 2 ] - timestamps[ 1 ];
+	record.fallback_seconds = timestamps[ 3 ] - timestamps[ 2 ];
+	convergence_log_->record( record );
+}
 
-	/* Iterate every vertex, checking its susceptibility to an
-	 * attribute disclosure (NAD) attack
-	 */
-	for( uint32_t v = 0; v < n_; ++v ) {
-		get_neighbourhood_ld( &neighbourhood, v );
-		const float distance = global->distance( neighbourhood );
-		if( distance > max_distance ) { max_distance = distance; }
-		delete neighbourhood;
+void LabelledGraph::add_edges( EdgeList const& edges ) {
+	if( edges.empty() ) { return; }
+
+	/* Fill the adjacency lists in parallel, one vertex per thread. */
+	GraphDelta delta;
+	delta.num_new_vertices = 0;
+	delta.new_edges = edges;
+	apply_delta( delta );
+
+	/* Then update the label counts and, if tracking, the distances of the endpoints. */
+	std::vector< char > touched( n_, 0 );
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		std::vector< uint32_t > const& labels = vertex_labels_[ attribute ];
+		std::vector< uint32_t > &counts = neighbourhood_label_counts_[ attribute ];
+		const uint32_t l = alphabet_sizes_[ attribute ];
+		for( auto const& e : edges ) {
+			++counts[ static_cast< size_t >( e.first ) * l + labels[ e.second ] ];
+			++counts[ static_cast< size_t >( e.second ) * l + labels[ e.first ] ];
+		}
+	}
+	for( auto const& e : edges ) { touched[ e.first ] = touched[ e.second ] = 1; }
+	if( tracker_ != NULL ) {
+		for( uint32_t v = 0; v < n_; ++v ) {
+			if( touched[ v ] ) { tracker_->update( v, tracked_distance( v ) ); }
+		}
 	}
-
-	delete global;
-	return max_distance <= alpha;
 }
 
-void LabelledGraph::hopeful( const float alpha ) {
-	bool leaks_privacy = !is_alpha_proximal( alpha );
-	while( leaks_privacy && !is_complete() ) {
-		if( is_alpha_proximal( alpha ) ) { leaks_privacy = false; }
-		else { add_random_edge(); }
+void LabelledGraph::match_label_pair( const uint32_t attribute, const uint32_t a, const uint32_t b, 
+	std::vector< std::pair< uint32_t, LabelSet > > const& visit_order, 
+	std::vector< uint32_t > const& bucket_start, std::vector< uint32_t > const& mates, 
+	const uint32_t first_pos, const uint32_t last_pos, std::vector< char > *lacking, 
+	EdgeList *new_edges ) const {
+
+	const uint32_t num_labels = alphabet_sizes_[ attribute ];
+
+	/* The vertices of label a that lack b, and those of label b that lack a 
+	 * (the same bucket if a == b), within the positions [first_pos, last_pos) 
+	 * of visit_order. Since each bucket lists positions in increasing order, 
+	 * these are contiguous ranges of mates (and so of lacking). */
+	const uint32_t bucket_ab = a * num_labels + b, bucket_ba = b * num_labels + a;
+	auto const range = [ & ]( const uint32_t bucket, uint32_t &begin, uint32_t &end ) {
+		uint32_t const* first = mates.data() + bucket_start[ bucket ];
+		uint32_t const* last = mates.data() + bucket_start[ bucket + 1 ];
+		begin = std::lower_bound( first, last, first_pos ) - mates.data();
+		end = std::lower_bound( first, last, last_pos ) - mates.data();
+	};
+	uint32_t begin_ab, end_ab, begin_ba, end_ba;
+	range( bucket_ab, begin_ab, end_ab );
+	range( bucket_ba, begin_ba, end_ba );
+	uint32_t head_ab = begin_ab, head_ba = begin_ba;
+
+	/* Gives the vertex at position pos in visit_order, whose entry in mates is 
+	 * i, the first later vertex among mates[ head, end ) that still lacks its 
+	 * label and is not yet its neighbour. The flags of both are cleared only 
+	 * once they are matched, so that a vertex without a mate in this range 
+	 * can still find one in a wider range. (No earlier vertex can choose it 
+	 * in the meantime, because mates always come later in visit_order.) */
+	auto const find_mate = [ & ]( const uint32_t pos, const uint32_t i, uint32_t &head, const uint32_t end ) {
+		if( !( *lacking )[ i ] ) { return; }
+		while( head < end && ( mates[ head ] <= pos || !( *lacking )[ head ] ) ) { ++head; }
+
+		const uint32_t v = visit_order[ pos ].first;
+		for( uint32_t j = head; j < end; ++j ) {
+			const uint32_t u = visit_order[ mates[ j ] ].first;
+			if( ( *lacking )[ j ] && adjacency_list_[ v ].count( u ) == 0 ) {
+				( *lacking )[ i ] = ( *lacking )[ j ] = 0;
+				new_edges->push_back( std::make_pair( v, u ) );
+				return; /* success! */
+			}
+		}
+	};
+
+	/* Visit both buckets in visit order, i.e., merge them by position. */
+	uint32_t i = begin_ab, j = begin_ba;
+	while( i < end_ab || ( a != b && j < end_ba ) ) {
+		if( a == b || j == end_ba || ( i < end_ab && mates[ i ] < mates[ j ] ) ) {
+			find_mate( mates[ i ], i, head_ba, end_ba );
+			++i;
+		}
+		else {
+			find_mate( mates[ j ], j, head_ab, end_ab );
+			++j;
+		}
 	}
 }
 
-uint32_t LabelledGraph::run_greedy_iteration( const float alpha ) {
+uint32_t LabelledGraph::insert_proposed_edges( std::vector< EdgeList > const& pair_edges ) {
+	EdgeList new_edges;
+	for( auto const& edges : pair_edges ) { new_edges.insert( new_edges.end(), edges.cbegin(), edges.cend() ); }
 
-	LabelDistribution *global, *neighbourhood;
-	std::vector< std::pair< uint32_t, uint32_t > > visit_order;
-	uint32_t num_edges_added = 0;
+	/* Different attributes may propose the same edge, which is inserted once. */
+	if( alphabet_sizes_.size() > 1 ) {
+		for( auto &e : new_edges ) { if( e.first > e.second ) { std::swap( e.first, e.second ); } }
+		std::sort( new_edges.begin(), new_edges.end() );
+		new_edges.erase( std::unique( new_edges.begin(), new_edges.end() ), new_edges.end() );
+	}
+	add_edges( new_edges );
+	return new_edges.size();
+}
 
-	get_global_ld( &global );
+void LabelledGraph::group_by_label( const uint32_t attribute, 
+	std::vector< std::vector< uint32_t > > *members ) const {
 
-	for( uint32_t i = 0; i < n_; ++i ) {
-
-		/* First determine which "partition" vertex i belongs to. */
-		get_neighbourhood_ld( &neighbourhood, i );
-		const uint32_t defs = neighbourhood->get_deficiencies( global, alpha );
+	members->assign( alphabet_sizes_[ attribute ], std::vector< uint32_t >() );
+	for( uint32_t v = 0; v < n_; ++v ) { ( *members )[ vertex_labels_[ attribute ][ v ] ].push_back( v ); }
+}
 
-		/* If vertex i is already alpha-proximal, exclude it
-		 * from further processing. */
-		if( defs > 0 ) {
-			visit_order.push_back ( std::pair< uint32_t, uint32_t > ( i, defs ) );
+void LabelledGraph::b_match( std::vector< uint32_t > const& sources, std::vector< uint32_t > const& source_caps, 
+	std::vector< uint32_t > const& sinks, std::vector< uint32_t > const& sink_caps, EdgeList *new_edges, 
+	std::vector< uint32_t > *unmet_sources, std::vector< uint32_t > *unmet_sinks ) const {
+
+	const uint32_t num_sources = sources.size(), num_sinks = sinks.size();
+	if( unmet_sources != NULL ) { unmet_sources->assign( source_caps.begin(), source_caps.end() ); }
+	if( unmet_sinks != NULL ) { unmet_sinks->assign( sink_caps.begin(), sink_caps.end() ); }
+	if( num_sources == 0 || num_sinks == 0 ) { return; }
+
+	/* Node 0 is the source of the flow and node 1 its sink, followed by 
+	 * a node per source vertex and then a node per sink vertex. */
+	FlowNetwork network( num_sources + num_sinks + 2 );
+	std::vector< uint32_t > source_arcs( num_sources ), sink_arcs( num_sinks );
+	for( uint32_t i = 0; i < num_sources; ++i ) { source_arcs[ i ] = network.add_arc( 0, 2 + i, source_caps[ i ] ); }
+	for( uint32_t j = 0; j < num_sinks; ++j ) { sink_arcs[ j ] = network.add_arc( 2 + num_sources + j, 1, sink_caps[ j ] ); }
+
+	/* Offer each source a window of consecutive sinks, the windows starting 
+	 * evenly spaced so that every sink is offered to some source. */
+	const uint32_t stride = ( num_sinks + num_sources - 1 ) / num_sources;
+	std::vector< std::pair< uint32_t, uint32_t > > mate_arcs; /* ( source, sink ) per arc */
+	std::vector< uint32_t > mate_arc_ids;
+	for( uint32_t i = 0; i < num_sources; ++i ) {
+		const uint32_t first = static_cast< uint64_t >( i ) * num_sinks / num_sources;
+		const uint32_t width = std::min< uint64_t >( num_sinks, 
+			static_cast< uint64_t >( source_caps[ i ] ) + stride + FLOW_CANDIDATE_SLACK );
+		for( uint32_t k = 0; k < width; ++k ) {
+			const uint32_t j = ( first + k ) % num_sinks;
+			if( adjacency_list_[ sources[ i ] ].count( sinks[ j ] ) == 0 ) {
+				mate_arc_ids.push_back( network.add_arc( 2 + i, 2 + num_sources + j, 1 ) );
+				mate_arcs.push_back( std::make_pair( i, j ) );
+			}
 		}
-
-		/* clean up from vertex i. */
-		delete neighbourhood;
 	}
 
-	/* Randomize the order of the points so that edges are added more
-	 * "evenly." */
-	std::random_shuffle( visit_order.begin(), visit_order.end() );
+	network.max_flow( 0, 1 );
+	for( uint32_t k = 0; k < mate_arcs.size(); ++k ) {
+		if( network.get_flow( mate_arc_ids[ k ] ) > 0 ) {
+			new_edges->push_back( std::make_pair( sources[ mate_arcs[ k ].first ], sinks[ mate_arcs[ k ].second ] ) );
+		}
+	}
+	if( unmet_sources != NULL ) {
+		for( uint32_t i = 0; i < num_sources; ++i ) { ( *unmet_sources )[ i ] -= network.get_flow( source_arcs[ i ] ); }
+	}
+	if( unmet_sinks != NULL ) {
+		for( uint32_t j = 0; j < num_sinks; ++j ) { ( *unmet_sinks )[ j ] -= network.get_flow( sink_arcs[ j ] ); }
+	}
+}
 
-	/* Process each deficient point v with label l1 by, for each deficient label
-	 * l2, finding a mate u with label l who is deficient in l2 and adding
-	 * edge (u,v) to the graph (if it can be done).
-	 */
-	for( auto it = visit_order.begin(); it != visit_order.end(); ++it ) {
-		/* redeclare for readability the variables related to this iteration. */
-		const uint32_t v = it->first;
-		const uint32_t v_label_bitmask = 1 << vertex_labels_[ v ];
-		uint32_t defs = it->second;
-		const uint32_t num_def_labels = __builtin_popcount( defs );
-
-		/* Iterate deficient labels, trying to correct them. */
-		for( uint32_t i = 0; i < num_def_labels; ++i ) {
-			/* grab next deficient label from bitmask */
-			const uint32_t l = ffs( defs ) - 1;
-
-			/* find a mate with whom to connect (if there is one) */
-			for( auto it_mate = it + 1; it_mate != visit_order.end(); ++it_mate ) {
-				if( it_mate->second & v_label_bitmask ) { /* mate deficient in my label */
-					if( vertex_labels_[ it_mate->first ] == l ) { /* mate offers my deficiency */
-						if( add_edge( v, it_mate->first ) ) {
-							it_mate->second ^= v_label_bitmask;
-							++num_edges_added;
-							break; /* success! */
-						}
-					}
-				}
+void LabelledGraph::match_demands( const uint32_t attribute, const uint32_t a, const uint32_t b, 
+	LabelDistribution const* global, std::vector< uint32_t > const& demands, 
+	std::vector< std::vector< uint32_t > > const& members, EdgeList *new_edges ) const {
+
+	const uint32_t num_labels = alphabet_sizes_[ attribute ];
+
+	/* The vertices of label a that demand b, and those of label b that demand a. 
+	 * Vertices of label a that demand a are split alternately over both sides. */
+	std::vector< uint32_t > side_a, caps_a, side_b, caps_b;
+	for( auto const u : members[ a ] ) {
+		const uint32_t demand = demands[ static_cast< size_t >( u ) * num_labels + b ];
+		if( demand == 0 ) { continue; }
+		const bool to_b = ( a == b && side_a.size() > side_b.size() );
+		( to_b ? side_b : side_a ).push_back( u );
+		( to_b ? caps_b : caps_a ).push_back( demand );
+	}
+	if( a != b ) {
+		for( auto const v : members[ b ] ) {
+			const uint32_t demand = demands[ static_cast< size_t >( v ) * num_labels + a ];
+			if( demand > 0 ) {
+				side_b.push_back( v );
+				caps_b.push_back( demand );
 			}
-
-			/* clear bit as having been resolved */
-			defs ^= 1 << ( l - 1 );
 		}
 	}
+	if( side_a.empty() && side_b.empty() ) { return; }
+
+	/* First match demands that are mutual, so that each edge serves both endpoints. */
+	std::vector< uint32_t > unmet_a, unmet_b;
+	b_match( side_a, caps_a, side_b, caps_b, new_edges, &unmet_a, &unmet_b );
+
+	/* Then match the unmet demands for label other_label of vertices with label own_label 
+	 * to vertices that demand nothing of own_label but still lack it. */
+	auto const match_unmet = [ & ]( std::vector< uint32_t > const& side, std::vector< uint32_t > const& unmet, 
+		const uint32_t own_label, const uint32_t other_label ) {
+
+		std::vector< uint32_t > sources, source_caps, sinks;
+		for( uint32_t i = 0; i < side.size(); ++i ) {
+			if( unmet[ i ] > 0 ) {
+				sources.push_back( side[ i ] );
+				source_caps.push_back( unmet[ i ] );
+			}
+		}
+		if( sources.empty() ) { return; }
+		for( auto const v : members[ other_label ] ) {
+			if( demands[ static_cast< size_t >( v ) * num_labels + own_label ] == 0 && 
+				pairwise_difference( get_neighbourhood_counts( attribute, v )[ own_label ], adjacency_list_[ v ].size() + 1, 
+					global->get_counts()[ own_label ], global->get_sum() ) < 0 ) {
+				sinks.push_back( v );
+			}
+		}
+		b_match( sources, source_caps, sinks, std::vector< uint32_t >( sinks.size(), 1 ), new_edges, NULL, NULL );
+	};
 
-	/* clean up and return */
-	delete global;
-	return num_edges_added;
-}
-
-void LabelledGraph::greedy( const float alpha ) {
-	bool leaks_privacy = !is_alpha_proximal( alpha );
-	while( leaks_privacy && !is_complete() ) {
-		const uint32_t num_new_edges = run_greedy_iteration( alpha );
-		if( is_alpha_proximal( alpha ) ) { leaks_privacy = false; }
-		else if ( num_new_edges == 0 ) { add_random_edge(); }
+	if( a != b ) {
+		match_unmet( side_a, unmet_a, a, b );
+		match_unmet( side_b, unmet_b, b, a );
+	}
+	else {
+		side_a.insert( side_a.end(), side_b.begin(), side_b.end() );
+		unmet_a.insert( unmet_a.end(), unmet_b.begin(), unmet_b.end() );
+		match_unmet( side_a, unmet_a, a, a );
 	}
 }
-
@@ -42,10 +42,51 @@
 
 #include "../unlabelled_graph/unlabelled_graph.h"
 #include "label_distribution.h"
+#include "alpha_proximity_tracker.h"
+#include "distance_kernels.h"
+#include "flow_network.h"
+#include "deficiency_sampler.h"
+#include "convergence_log.h"
+
+/**
+ * The number of random edges that hopeful() draws and filters at once.
+ */
+#define HOPEFUL_BATCH_SIZE 4096
+
+/**
+ * The number of deficient vertices of a label pair beyond which 
+ * run_greedy_iteration() splits its matching into concurrent chunks.
+ */
+#define GREEDY_PAIR_CHUNK_SIZE 16384
+
+/**
+ * The number of elements per block in the parallel shuffle with which 
+ * evenly_distribute_labels() assigns labels to vertices.
+ */
+#define LABEL_SHUFFLE_BLOCK_SIZE 65536
+
+/**
+ * The number of candidate mates beyond its demand that each vertex is 
+ * offered in the flow networks of flow_matching().
+ */
+#define FLOW_CANDIDATE_SLACK 4
+
+/**
+ * The number of vertices with the lacking label beyond the first possible 
+ * partner that add_targeted_edge() scans for a partner that in turn lacks 
+ * the label of the deficient vertex.
+ */
+#define DEFICIENCY_PARTNER_SCAN 8
 
 /**
  * @brief A simple, undirected, vertex-labelled graph with no self-loops that is
  * equipped with methods for attribute disclosure protection.
+ * 
+ * Each vertex has one label per sensitive attribute (e.g., age band, region, 
+ * and diagnosis), and each attribute has its own label alphabet. The graph 
+ * is alpha-proximal if it is alpha-proximal with respect to every attribute, 
+ * i.e., if, for each vertex, the largest distance of any attribute's 
+ * neighbourhood LabelDistribution to the global one is at most alpha.
  * @extends UnlabelledGraph
  * @todo Unit test this class, particular the is_alpha_proximal() and
  * greedy() methods.
@@ -62,7 +103,10 @@ public:
 	 * of this constructor is undefined.
 	 * @see <a href="../../workloads/paper_example.adjList">An example file</a>
 	 * consisting of the example LabelledGraph from Figure 1 of @cite asonam ,
-	 * represented in the vertex-labelled adjacency list format.
+	 * represented in the vertex-labelled adjacency list format. The first line 
+	 * may list the alphabet sizes of several attributes after the number of 
+	 * vertices, in which case each vertex's line starts with one label per 
+	 * attribute, in the same order.
 	 */
 	LabelledGraph( const std::string filename );
 
@@ -72,35 +116,110 @@ public:
 	 * @param num_vertices The number of vertices in the graph.
 	 * @param num_labels The size of the label alphabet (i.e., the
 	 * number of unique vertex labels).
-	 * @post Constructs a new LabelledGraph object
+	 * @post Constructs a new LabelledGraph object with a single attribute
 	 */
 	LabelledGraph( const uint32_t num_vertices, const uint32_t num_labels );
 
+	/**
+	 * Constructs a graph with n isolated vertices, each of which is labelled 
+	 * with several attributes.
+	 * @param num_vertices The number of vertices in the graph.
+	 * @param alphabet_sizes The size of the label alphabet of each attribute.
+	 * @post Constructs a new LabelledGraph object
+	 */
+	LabelledGraph( const uint32_t num_vertices, std::vector< uint32_t > const& alphabet_sizes );
+
+	/**
+	 * LabelledGraphs own their tracking state, so they are not implicitly copied.
+	 * @see clone()
+	 */
+	LabelledGraph( LabelledGraph const& ) = delete;
+	LabelledGraph& operator=( LabelledGraph const& ) = delete;
+
 	/**
 	 * Destroys the LabelledGraph.
 	 */
 	virtual ~LabelledGraph();
 
+	/**
+	 * Copies the edges and labels of the graph.
+	 * @return A new LabelledGraph, which the caller must delete, that neither 
+	 * tracks alpha-proximity nor logs convergence.
+	 */
+	LabelledGraph* clone() const;
+
 	/**
 	 * Initializes empty LabelledGraph data structures: should be called
-	 * by all overloaded constructors once n_ and l_ are set.
+	 * by all overloaded constructors once n_ and alphabet_sizes_ are set.
 	 */
 	void init();
 
 	/**
-	 * Assigns a random label to each vertex such that (to the maximum extent
-	 * possible) every label appears with the same frequency.
+	 * Accessor method to return the number of attributes with which each 
+	 * vertex is labelled.
+	 * @return The number of label columns.
+	 */
+	uint32_t num_attributes() const { return alphabet_sizes_.size(); }
+
+	/**
+	 * Assigns a random label to each vertex, for each attribute, such that 
+	 * (to the maximum extent possible) every label of an attribute appears 
+	 * with the same frequency.
+	 * 
+	 * Each label of an alphabet of size l is written n_ / l times into an 
+	 * array, the remainder going to distinct random labels, and the array is 
+	 * then permuted uniformly at random in parallel, in O(n) time per attribute.
+	 * @param seed The seed for the random permutation of the first attribute 
+	 * (and, incremented by i, of the i'th): the same seed always produces the 
+	 * same labelling, regardless of the number of threads.
 	 */
-	void evenly_distribute_labels();
+	void evenly_distribute_labels( const uint32_t seed );
 
 	/**
 	 * Determines whether this graph is alpha-proximal.
+	 * @tparam Metric The proximity metric with which distances are measured.
 	 * @param alpha The privacy threshold
-	 * @return True if every vertex has a LabelDistribution within a distance
-	 * of alpha of the global LabelDistribution
+	 * @return True if every vertex has, for every attribute, a LabelDistribution 
+	 * within a distance of alpha of the global LabelDistribution
 	 * @see Definition 2.6 of @cite asonam
+	 * @note Answered in O(1) while the alpha-proximity of the graph is 
+	 * being tracked for the same alpha and metric; otherwise computed from scratch.
+	 * @see track_alpha_proximity()
 	 */
-	bool is_alpha_proximal( const float alpha );
+	template < class Metric = L1Distance >
+	bool is_alpha_proximal( Rational const& alpha );
+
+	/**
+	 * Starts maintaining, for the given privacy threshold, the distance of every 
+	 * vertex's neighbourhood to the global LabelDistribution (the largest over 
+	 * all attributes), so that each edge insertion only updates its two 
+	 * endpoints in O(l + log n), where l is the total size of the alphabets.
+	 * @tparam Metric The proximity metric, whose distance() rule is then 
+	 * applied to the endpoints of every new edge.
+	 * @param alpha The privacy threshold
+	 * @post is_alpha_proximal() and num_deficient_vertices() take O(1) time 
+	 * for this alpha and metric until untrack_alpha_proximity() is called or 
+	 * the labels change.
+	 */
+	template < class Metric = L1Distance >
+	void track_alpha_proximity( Rational const& alpha );
+
+	/**
+	 * Stops tracking the alpha-proximity of the graph and frees the tracker.
+	 * @see track_alpha_proximity()
+	 */
+	void untrack_alpha_proximity();
+
+	/**
+	 * Counts the vertices whose neighbourhood LabelDistribution, for any 
+	 * attribute, is further than alpha from the global LabelDistribution.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @return The number of vertices that are not yet alpha-proximal.
+	 * @note Answered in O(1) while tracking the same alpha and metric.
+	 */
+	template < class Metric = L1Distance >
+	uint32_t num_deficient_vertices( Rational const& alpha );
 
 	/**
 	 * Naively transforms the graph into an alpha-proximal graph by alternately
@@ -108,19 +227,66 @@ public:
 	 * algorithm is guaranteed to reach a solution because the complete graph is
 	 * a solution (every vertex's neighbourhood LabelDistribution is exactly the global
 	 * LabelDistribution).
+	 * 
+	 * Random edges are drawn in batches of HOPEFUL_BATCH_SIZE, from which 
+	 * existing edges are discarded in parallel, and alpha-proximity is tracked 
+	 * incrementally. The graph thus stops at exactly the same edge as when 
+	 * inserting one edge with add_random_edge() and then calling 
+	 * is_alpha_proximal() each time, but the remainder of the last batch 
+	 * will have been drawn from rand().
+	 * @tparam Metric The proximity metric with which distances are measured.
 	 * @param alpha The privacy threshold
 	 * @post Inserts edges into the graph so that the graph is alpha-proximal
+	 * @see track_alpha_proximity()
 	 */
-	void hopeful( const float alpha );
+	template < class Metric = L1Distance >
+	void hopeful( Rational const& alpha );
 
 	/**
 	 * Transforms the graph into an alpha-proximal graph, using the Greedy
 	 * alpha-proximity algorithm from @cite asonam (Algorithm 1), hopefully
-	 * inducing much fewer edge additions than the hopeful algorithm.
+	 * inducing much fewer edge additions than the hopeful algorithm. Each 
+	 * iteration addresses the deficiencies of all attributes at once.
+	 * 
+	 * When an iteration adds no edges, edges are instead drawn for deficient 
+	 * vertices from a DeficiencySampler (see add_fallback_edges()), rather 
+	 * than uniformly at random.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @post Inserts edges into the graph so that the graph is alpha-proximal
+	 */
+	template < class Metric = L1Distance >
+	void greedy( Rational const& alpha );
+
+	/**
+	 * Transforms the graph into an alpha-proximal graph by adding a near-minimal 
+	 * set of edges, computed with maximum flows rather than greedily.
+	 * 
+	 * Each iteration first determines, for every vertex and attribute, the 
+	 * fewest neighbours of each label that would make the vertex alpha-proximal 
+	 * (its demands). For every pair of labels (a, b), the vertices of label a 
+	 * that demand b and those of label b that demand a are then matched as a 
+	 * b-matching, i.e., a maximum flow solved by push-relabel, so that each 
+	 * edge satisfies a demand at both endpoints. Demands left unmet are then 
+	 * matched, with a second flow, to vertices that are already alpha-proximal 
+	 * but still lack the label of the other endpoint. As in greedy(), fallback 
+	 * edges are added if an iteration finds no edges.
+	 * @tparam Metric The proximity metric with which distances are measured.
 	 * @param alpha The privacy threshold
 	 * @post Inserts edges into the graph so that the graph is alpha-proximal
+	 * @see FlowNetwork
+	 */
+	template < class Metric = L1Distance >
+	void flow_matching( Rational const& alpha );
+
+	/**
+	 * Directs greedy(), hopeful(), and flow_matching() to record the 
+	 * telemetry of every iteration (for hopeful(), of every batch) in a log. 
+	 * Without a log, they skip all timing and recording.
+	 * @param log The log to record to, which is not owned by the graph and 
+	 * must outlive its use, or NULL to stop recording.
 	 */
-	void greedy( const float alpha );
+	void log_convergence( ConvergenceLog *log ) { convergence_log_ = log; }
 
 	/**
 	 * Prints the graph to outstream in vertex-labelled adjacency list format
@@ -134,50 +300,355 @@ public:
 
 private:
 
+	/**
+	 * Constructs a copy of the edges and labels of another graph, without 
+	 * its tracking state or convergence log.
+	 * @param other The graph to copy.
+	 * @see clone()
+	 */
+	explicit LabelledGraph( LabelledGraph const* other );
+
 	/**
 	 * Obtains and constructs at address ld a LabelDistribution
-	 * corresponding to the global frequencies of all labels for all
-	 * vertices in the graph.
+	 * corresponding to the global frequencies of all labels of an attribute 
+	 * for all vertices in the graph.
+	 * @param attribute The attribute whose labels are counted.
 	 * @param ld The address at which the new LabelDistribution should
 	 * be constructted.
 	 * @post ld contains a new LabelDistribution instance.
 	 */
-	void inline get_global_ld( LabelDistribution **ld );
+	void get_global_ld( const uint32_t attribute, LabelDistribution **ld );
 
 	/**
-	 * Obtains and constructs at address ld a LabelDistribution
-	 * corresponding to the frequencies of all labels of vertices
-	 * within the 1-hop neighbourhood of vertex v.
-	 * @param ld The address at which the new LabelDistribution should
-	 * be constructed.
-	 * @param v The vertex id for whom the neighbourhood LabelDistribution
-	 * should be calculated
-	 * @post ld contains a new LabelDistribution instance.
+	 * Returns the frequencies of all labels of an attribute of vertices within 
+	 * the 1-hop neighbourhood of vertex v (including v itself), read in place 
+	 * from the attribute's neighbourhood label-count matrix.
+	 * @param attribute The attribute whose labels are counted.
+	 * @param v The vertex id for whom the neighbourhood label counts 
+	 * should be retrieved.
+	 * @return A pointer to alphabet_sizes_[ attribute ] counts, which sum to 
+	 * the degree of v plus one. It is invalidated by any change to the labels.
+	 */
+	uint32_t const* get_neighbourhood_counts( const uint32_t attribute, const uint32_t v ) const {
+		return neighbourhood_label_counts_[ attribute ].data() 
+			+ static_cast< size_t >( v ) * alphabet_sizes_[ attribute ];
+	}
+
+	/**
+	 * Calculates exactly the distance of a vertex's neighbourhood to the 
+	 * tracked global LabelDistributions with the tracked metric, i.e., the 
+	 * largest over all attributes.
+	 * @param v The vertex id.
+	 * @return The distance that the tracker maintains for v.
+	 * @pre Alpha-proximity is being tracked.
+	 */
+	Rational tracked_distance( const uint32_t v ) const;
+
+	/**
+	 * Recomputes the neighbourhood label-count matrices from scratch: must be 
+	 * called whenever vertex labels are (re)assigned.
+	 * @post Row v of each attribute's neighbourhood label-count matrix counts 
+	 * the labels in the 1-hop neighbourhood of v, including v itself.
+	 */
+	void count_neighbourhood_labels();
+
+	/**
+	 * Computes the exact distance of every vertex's neighbourhood to the 
+	 * global LabelDistribution of an attribute and/or its deficiencies, 
+	 * DISTANCE_BLOCK_SIZE vertices at a time: each block of rows of the 
+	 * attribute's neighbourhood label-count matrix is transposed into 
+	 * structure-of-arrays layout and handed to the vectorised kernel selected 
+	 * for the metric and the attribute's alphabet size.
+	 * @tparam Metric The proximity metric.
+	 * @param attribute The attribute whose labels are compared.
+	 * @param global The global LabelDistribution of the attribute.
+	 * @param distances The vector in which to store the distance of each 
+	 * vertex, as LabelDistribution::distance< Metric >() would, or NULL.
+	 * @param alpha The privacy threshold, if deficiencies is not NULL.
+	 * @param deficiencies The vector in which to store the deficiencies of 
+	 * each vertex, as LabelDistribution::get_deficiencies_of< Metric >() would, or NULL.
+	 * @pre distances and deficiencies, if given, have n_ elements.
+	 * @see select_distance_kernel() and the block() of each Metric
 	 */
-	void inline get_neighbourhood_ld( LabelDistribution **ld, const uint32_t v );
+	template < class Metric = L1Distance >
+	void compute_neighbourhood_distances( const uint32_t attribute, LabelDistribution const* global, 
+		std::vector< Rational > *distances, Rational const* alpha, 
+		std::vector< LabelSet > *deficiencies ) const;
 
+	/**
+	 * Computes the exact distance of every vertex's neighbourhood to the 
+	 * global LabelDistributions, i.e., the largest over all attributes.
+	 * @tparam Metric The proximity metric.
+	 * @param globals The global LabelDistribution of each attribute.
+	 * @param distances The vector in which to store the distance of each 
+	 * vertex, which must have n_ elements.
+	 * @see compute_neighbourhood_distances()
+	 */
+	template < class Metric = L1Distance >
+	void compute_composite_distances( std::vector< LabelDistribution* > const& globals, 
+		std::vector< Rational > *distances ) const;
+
+	/**
+	 * Inserts the undirected edge (u,v) into the graph if it does not already 
+	 * exist, and if so increments the label counts of both neighbourhoods 
+	 * for every attribute.
+	 * @param u The source vertex of the edge
+	 * @param v The destination vertex of the edge
+	 * @return True if the edge was added, false if it already existed
+	 * @see UnlabelledGraph::add_edge()
+	 */
+	bool add_edge( const uint32_t u, const uint32_t v ) override;
+
+
+	/**
+	 * Inserts many new edges at once, filling the adjacency lists in parallel.
+	 * @param edges The edges to insert, none of which may exist yet and each 
+	 * of which must appear only once.
+	 * @post The graph, its neighbourhood label counts, and the tracked 
+	 * alpha-proximity (if any) contain all of the edges.
+	 * @see UnlabelledGraph::apply_delta()
+	 */
+	void add_edges( EdgeList const& edges );
+
+	/**
+	 * Computes the edges that one iteration of the Greedy Alpha-Proximity 
+	 * algorithm adds between vertices of labels a and b of an attribute, 
+	 * among the vertices in a range of positions of visit_order, without 
+	 * modifying the graph.
+	 * @param attribute The attribute that a and b are labels of.
+	 * @param a The label of one side of the edges.
+	 * @param b The label of the other side of the edges, with a <= b.
+	 * @param visit_order The deficient vertices and their deficiencies in the 
+	 * attribute, in the order in which they are processed.
+	 * @param bucket_start The start of each (label, deficient label) bucket 
+	 * of the attribute within mates, as built by run_greedy_iteration().
+	 * @param mates The positions in visit_order of the vertices in each bucket.
+	 * @param first_pos The first position of visit_order to match.
+	 * @param last_pos One past the last position of visit_order to match.
+	 * @param lacking Whether each entry of mates still lacks a neighbour with 
+	 * the label of its bucket, which is cleared for both ends of each new edge.
+	 * @param new_edges The list to which the new edges are appended.
+	 */
+	void match_label_pair( const uint32_t attribute, const uint32_t a, const uint32_t b, 
+		std::vector< std::pair< uint32_t, LabelSet > > const& visit_order, 
+		std::vector< uint32_t > const& bucket_start, std::vector< uint32_t > const& mates, 
+		const uint32_t first_pos, const uint32_t last_pos, std::vector< char > *lacking, 
+		EdgeList *new_edges ) const;
 
 	/**
 	 * Runs an iteration of the Greedy Alpha-Proximity algorithm (Lines 2--4 in
 	 * Algorithm 1 of @cite asonam ).
+	 * 
+	 * The deficiencies of each attribute are computed in parallel over the 
+	 * vertices, and the mates in parallel over the label pairs of all 
+	 * attributes with match_label_pair(), after which the new edges of all 
+	 * attributes are inserted in one batch with add_edges(). For each label 
+	 * pair of at most GREEDY_PAIR_CHUNK_SIZE deficient vertices, the result 
+	 * is the same as matching every vertex in turn; larger pairs are first 
+	 * matched in parallel chunks and then finished in turn.
+	 * @tparam Metric The proximity metric with which deficient vertices are found.
 	 * @param alpha The privacy threshold
 	 * @return The number of edges that were added to the graph during
 	 * this iteration
 	 * @post The graph contains new edges and has greedily moved closer to being
 	 * alpha-proximal.
 	 */
-	uint32_t run_greedy_iteration( const float alpha );
+	template < class Metric = L1Distance >
+	uint32_t run_greedy_iteration( Rational const& alpha );
+
+	/**
+	 * Computes, for every vertex, how many neighbours of each label of an 
+	 * attribute to add so that its neighbourhood becomes alpha-proximal, by 
+	 * repeatedly adding the label that is most under-represented until it is.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param attribute The attribute whose labels are demanded.
+	 * @param global The global LabelDistribution of the attribute.
+	 * @param alpha The privacy threshold
+	 * @param demands The row-major n_ x l matrix in which to store the demand 
+	 * of each vertex for each of the l labels of the attribute.
+	 */
+	template < class Metric >
+	void compute_demands( const uint32_t attribute, LabelDistribution const* global, 
+		Rational const& alpha, std::vector< uint32_t > *demands ) const;
+
+	/**
+	 * Matches sources to sinks with a maximum b-matching that avoids existing 
+	 * edges, solved as a maximum flow. Each source is offered a window of 
+	 * sinks (its demand plus FLOW_CANDIDATE_SLACK, spread evenly over sinks).
+	 * @param sources The vertices on one side.
+	 * @param source_caps The number of mates that each source wants.
+	 * @param sinks The vertices on the other side, disjoint from sources.
+	 * @param sink_caps The number of mates that each sink wants.
+	 * @param new_edges The list to which the matched edges are appended.
+	 * @param unmet_sources If not NULL, the vector in which to store the demand 
+	 * of each source that was not matched.
+	 * @param unmet_sinks Likewise for the sinks.
+	 */
+	void b_match( std::vector< uint32_t > const& sources, std::vector< uint32_t > const& source_caps, 
+		std::vector< uint32_t > const& sinks, std::vector< uint32_t > const& sink_caps, EdgeList *new_edges, 
+		std::vector< uint32_t > *unmet_sources, std::vector< uint32_t > *unmet_sinks ) const;
+
+	/**
+	 * Computes the edges with which one iteration of flow_matching() 
+	 * satisfies the demands between labels a and b of an attribute, without 
+	 * modifying the graph.
+	 * @param attribute The attribute that a and b are labels of.
+	 * @param a The label of one side of the edges.
+	 * @param b The label of the other side of the edges, with a <= b.
+	 * @param global The global LabelDistribution of the attribute.
+	 * @param demands The demands, as computed by compute_demands().
+	 * @param members The vertices of each label of the attribute.
+	 * @param new_edges The list to which the new edges are appended.
+	 */
+	void match_demands( const uint32_t attribute, const uint32_t a, const uint32_t b, 
+		LabelDistribution const* global, std::vector< uint32_t > const& demands, 
+		std::vector< std::vector< uint32_t > > const& members, EdgeList *new_edges ) const;
+
+	/**
+	 * Runs an iteration of flow_matching(), matching the label pairs of all 
+	 * attributes in parallel and inserting their edges in one batch.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @return The number of edges that were added to the graph during
+	 * this iteration
+	 */
+	template < class Metric >
+	uint32_t run_flow_iteration( Rational const& alpha );
+
+	/**
+	 * Merges the edges proposed for each label pair and inserts them, once 
+	 * each, with add_edges().
+	 * @param pair_edges The edges proposed for each label pair, which are 
+	 * not yet in the graph. Only edges proposed for different attributes 
+	 * may coincide.
+	 * @return The number of edges that were inserted.
+	 */
+	uint32_t insert_proposed_edges( std::vector< EdgeList > const& pair_edges );
+
+	/**
+	 * Tracks alpha-proximity and runs iterations of an algorithm until the 
+	 * graph is alpha-proximal, adding fallback edges (see 
+	 * add_fallback_edges()) after any iteration that adds none, and 
+	 * recording each iteration to the convergence log.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @tparam Step The iteration, e.g., run_greedy_iteration< Metric >, 
+	 * which returns the number of edges that it added.
+	 * @param alpha The privacy threshold
+	 * @post Inserts edges into the graph so that the graph is alpha-proximal
+	 */
+	template < class Metric, uint32_t ( LabelledGraph::*Step )( Rational const& ) >
+	void iterate_until_alpha_proximal( Rational const& alpha );
+
+	/**
+	 * Lists the vertices that have each label of an attribute.
+	 * @param attribute The attribute by whose labels to group the vertices.
+	 * @param members The vector in which to store, for each label, the 
+	 * vertices with that label in increasing order.
+	 */
+	void group_by_label( const uint32_t attribute, std::vector< std::vector< uint32_t > > *members ) const;
+
+	/**
+	 * Constructs a sampler over every label that each vertex lacks in an 
+	 * attribute in which it is not alpha-proximal, weighted by the shortfall 
+	 * in the relative frequency of the label.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @return A new DeficiencySampler, which the caller must delete.
+	 * @pre Alpha-proximity is being tracked.
+	 */
+	template < class Metric >
+	DeficiencySampler* make_deficiency_sampler( Rational const& alpha ) const;
+
+	/**
+	 * Draws deficiencies from sampler until one is found that an edge can 
+	 * reduce, and adds such an edge: from the deficient vertex to a vertex 
+	 * with the label that it lacks, preferably one that in turn lacks the 
+	 * label of the deficient vertex. Partners are found by scanning the 
+	 * vertices with that label from a random position, for at most 
+	 * DEFICIENCY_PARTNER_SCAN vertices past the first possible one. 
+	 * Deficiencies that have cleared (or whose vertex is already adjacent to 
+	 * every vertex with the label) are removed from the sampler along the way.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @param sampler The sampler from which to draw deficiencies.
+	 * @param members The vertices of each label of each attribute.
+	 * @return True if an edge was added, or false if the sampler ran empty.
+	 * @pre Alpha-proximity is being tracked.
+	 */
+	template < class Metric >
+	bool add_targeted_edge( Rational const& alpha, DeficiencySampler *sampler, 
+		std::vector< std::vector< std::vector< uint32_t > > > const& members );
+
+	/**
+	 * Adds edges when an iteration of greedy() or flow_matching() has added 
+	 * none: targeted edges (see add_targeted_edge()) until fewer vertices 
+	 * are deficient than before. If the sampler runs empty first, it is 
+	 * rebuilt from the current deficiencies, and only if the rebuilt sampler 
+	 * is empty too is a random edge added instead. Unlike a random edge, each 
+	 * targeted edge reduces the distance of a deficient vertex.
+	 * @tparam Metric The proximity metric with which distances are measured.
+	 * @param alpha The privacy threshold
+	 * @param sampler The address of the sampler to draw from, which is 
+	 * constructed first if NULL, so that it carries over between consecutive 
+	 * calls. (The caller deletes it once other edges have been added.)
+	 * @param members The vertices of each label of each attribute.
+	 * @pre Alpha-proximity is being tracked.
+	 */
+	template < class Metric >
+	void add_fallback_edges( Rational const& alpha, DeficiencySampler **sampler, 
+		std::vector< std::vector< std::vector< uint32_t > > > const& members );
+
+	/**
+	 * Reads the clock for the convergence log.
+	 * @return The wall-clock time in seconds, or 0 if there is no log.
+	 */
+	double log_timestamp() const;
+
+	/**
+	 * Records an iteration to the convergence log, if there is one, with the 
+	 * distances as they are tracked after the iteration.
+	 * @param alpha The privacy threshold
+	 * @param iteration The number of the iteration.
+	 * @param new_edges The number of edges added by its main step.
+	 * @param fallback_edges The number of edges added as a fallback.
+	 * @param timestamps The log_timestamp()s before the main step, after it, 
+	 * after the alpha-proximity check, and after the fallback.
+	 * @pre Alpha-proximity is being tracked.
+	 */
+	void log_iteration( Rational const& alpha, const uint32_t iteration, const uint32_t new_edges, 
+		const uint32_t fallback_edges, double const* timestamps ) const;
 
 
 	/* Private member variables. */
 	/**
-	 * The vertex-labelling function (i.e., a mapping between vertex and
-	 * vertex label).
+	 * The vertex-labelling function of each attribute (i.e., a mapping between 
+	 * vertex and vertex label), stored column-wise: vertex_labels_[ a ][ v ] 
+	 * is the label of vertex v for attribute a.
+	 */
+	std::vector< std::vector< uint32_t > > vertex_labels_;
+	/**
+	 * The size of the label set of each attribute.
+	 */
+	std::vector< uint32_t > alphabet_sizes_;
+	/**
+	 * For each attribute a, a row-major n_ x alphabet_sizes_[ a ] matrix in 
+	 * which the v'th row holds the frequency of each label within the 1-hop 
+	 * neighbourhood of vertex v (including v itself). They are maintained 
+	 * together, incrementally, by add_edge().
+	 */
+	std::vector< std::vector< uint32_t > > neighbourhood_label_counts_;
+	/**
+	 * The global LabelDistribution of each attribute and the distance of each 
+	 * vertex to them, while alpha-proximity is being tracked; empty/NULL otherwise.
 	 */
-	std::vector< uint32_t > vertex_labels_;
-	uint32_t l_; /**< The size of the label set. */
+	std::vector< LabelDistribution* > tracked_global_lds_;
+	AlphaProximityTracker *tracker_ = NULL; /**< @see tracked_global_lds_ */
+	MetricDistance tracked_metric_ = NULL; /**< @see tracked_global_lds_ */
+	ConvergenceLog *convergence_log_ = NULL; /**< @see log_convergence() */
 	
 };
 
 
+#include "labelled_graph.tpp"
+
 #endif /* LABELLED_GRAPH_H_ */
@@ -0,0 +1,565 @@
+/**
+ * @file
+ * @brief Implementation of the LabelledGraph methods that are templated on
+ * a proximity metric.
+ * @see distance_kernels.h for the proximity metrics.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>		/* for uint32_t */
+#include <algorithm>	/* for random_shuffle, std::min, std::sort, std::unique */
+#include <cstdlib>		/* for rand */
+#include <numeric>		/* for std::partial_sum() */
+
+/* STL stuff in use. */
+#include <vector>
+
+template < class Metric >
+bool LabelledGraph::is_alpha_proximal( Rational const& alpha ) {
+	if( tracker_ != NULL && tracked_metric_ == &Metric::distance && tracker_->get_alpha() == alpha ) {
+		return tracker_->is_alpha_proximal();
+	}
+
+	std::vector< LabelDistribution* > globals( alphabet_sizes_.size() );
+	std::vector< Rational > distances( n_ );
+	Rational max_distance{ 0, 1 };
+
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		get_global_ld( attribute, &globals[ attribute ] );
+	}
+
+	/* Iterate every vertex, checking its susceptibility to an
+	 * attribute disclosure (NAD) attack
+	 */
+	compute_composite_distances< Metric >( globals, &distances );
+	for( uint32_t v = 0; v < n_; ++v ) {
+		if( distances[ v ] > max_distance ) { max_distance = distances[ v ]; }
+	}
+
+	for( auto global : globals ) { delete global; }
+	return max_distance <= alpha;
+}
+
+template < class Metric >
+void LabelledGraph::track_alpha_proximity( Rational const& alpha ) {
+	untrack_alpha_proximity();
+	tracked_global_lds_.resize( alphabet_sizes_.size() );
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		get_global_ld( attribute, &tracked_global_lds_[ attribute ] );
+	}
+
+	std::vector< Rational > distances( n_ );
+	compute_composite_distances< Metric >( tracked_global_lds_, &distances );
+	tracker_ = new AlphaProximityTracker( distances, alpha );
+	tracked_metric_ = &Metric::distance;
+}
+
+template < class Metric >
+void LabelledGraph::compute_neighbourhood_distances( const uint32_t attribute, LabelDistribution const* global, 
+	std::vector< Rational > *distances, Rational const* alpha, 
+	std::vector< LabelSet > *deficiencies ) const {
+
+	const uint32_t num_labels = alphabet_sizes_[ attribute ];
+	const DistanceKernel kernel = select_distance_kernel< Metric >( num_labels );
+	const uint32_t num_blocks = ( n_ + DISTANCE_BLOCK_SIZE - 1 ) / DISTANCE_BLOCK_SIZE;
+
+#pragma omp parallel
+	{
+		/* Thread-local block of counts, transposed so that lane j holds vertex j. */
+		std::vector< uint32_t > block_counts( static_cast< size_t >( num_labels ) * DISTANCE_BLOCK_SIZE );
+		uint32_t block_sums[ DISTANCE_BLOCK_SIZE ];
+		uint64_t block_distances[ DISTANCE_BLOCK_SIZE ];
+		uint64_t block_differences[ DISTANCE_BLOCK_SIZE ];
+		uint64_t block_deficiencies[ DISTANCE_BLOCK_SIZE ];
+
+#pragma omp for schedule( dynamic, 4 )
+		for( uint32_t b = 0; b < num_blocks; ++b ) {
+			const uint32_t first = b * DISTANCE_BLOCK_SIZE;
+			const uint32_t size = std::min< uint32_t >( DISTANCE_BLOCK_SIZE, n_ - first );
+
+			for( uint32_t j = 0; j < DISTANCE_BLOCK_SIZE; ++j ) {
+				if( j < size ) {
+					uint32_t const* counts = get_neighbourhood_counts( attribute, first + j );
+					for( uint32_t i = 0; i < num_labels; ++i ) { block_counts[ i * DISTANCE_BLOCK_SIZE + j ] = counts[ i ]; }
+					block_sums[ j ] = adjacency_list_[ first + j ].size() + 1;
+				}
+				else {
+					/* Pad a partial block with empty neighbourhoods of positive sum. */
+					for( uint32_t i = 0; i < num_labels; ++i ) { block_counts[ i * DISTANCE_BLOCK_SIZE + j ] = 0; }
+					block_sums[ j ] = 1;
+				}
+			}
+
+			kernel( block_counts.data(), block_sums, global->get_counts(), global->get_sum(), num_labels, 
+				block_distances, block_differences, block_deficiencies );
+
+			for( uint32_t j = 0; j < size; ++j ) {
+				const uint64_t denominator = Metric::denominator( block_sums[ j ], global->get_sum(), num_labels );
+				if( distances != NULL ) {
+					( *distances )[ first + j ] = Rational{ block_distances[ j ], denominator };
+				}
+				if( deficiencies == NULL ) { continue; }
+
+				LabelSet lacking( num_labels );
+				if( !( Rational{ block_differences[ j ], denominator } < *alpha ) ) {
+					if( num_labels > 64 ) {
+						/* The kernel's bitmask only covers the first 64 labels. */
+						lacking = global->get_deficiencies_of< Metric >( get_neighbourhood_counts( attribute, first + j ), 
+							block_sums[ j ], *alpha );
+					}
+					else {
+						for( uint64_t mask = block_deficiencies[ j ]; mask != 0; mask &= mask - 1 ) {
+							lacking.set( __builtin_ctzll( mask ) );
+						}
+					}
+				}
+				( *deficiencies )[ first + j ] = std::move( lacking );
+			}
+		}
+	}
+}
+
+template < class Metric >
+void LabelledGraph::compute_composite_distances( std::vector< LabelDistribution* > const& globals, 
+	std::vector< Rational > *distances ) const {
+
+	compute_neighbourhood_distances< Metric >( 0, globals[ 0 ], distances, NULL, NULL );
+	if( alphabet_sizes_.size() == 1 ) { return; }
+
+	std::vector< Rational > attribute_distances( n_ );
+	for( uint32_t attribute = 1; attribute < alphabet_sizes_.size(); ++attribute ) {
+		compute_neighbourhood_distances< Metric >( attribute, globals[ attribute ], &attribute_distances, NULL, NULL );
+#pragma omp parallel for schedule( static )
+		for( uint32_t v = 0; v < n_; ++v ) {
+			if( attribute_distances[ v ] > ( *distances )[ v ] ) { ( *distances )[ v ] = attribute_distances[ v ]; }
+		}
+	}
+}
+
+template < class Metric >
+uint32_t LabelledGraph::num_deficient_vertices( Rational const& alpha ) {
+	if( tracker_ != NULL && tracked_metric_ == &Metric::distance && tracker_->get_alpha() == alpha ) {
+		return tracker_->num_deficient();
+	}
+
+	std::vector< LabelDistribution* > globals( alphabet_sizes_.size() );
+	std::vector< Rational > distances( n_ );
+	uint32_t num_deficient = 0;
+
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		get_global_ld( attribute, &globals[ attribute ] );
+	}
+	compute_composite_distances< Metric >( globals, &distances );
+	for( uint32_t v = 0; v < n_; ++v ) {
+		if( distances[ v ] > alpha ) { ++num_deficient; }
+	}
+
+	for( auto global : globals ) { delete global; }
+	return num_deficient;
+}
+
+template < class Metric >
+void LabelledGraph::hopeful( Rational const& alpha ) {
+	/* Each random edge then only updates the distances of its endpoints. */
+	track_alpha_proximity< Metric >( alpha );
+
+	std::vector< std::pair< uint32_t, uint32_t > > candidates( HOPEFUL_BATCH_SIZE );
+	std::vector< char > is_new( HOPEFUL_BATCH_SIZE );
+	bool leaks_privacy = !tracker_->is_alpha_proximal();
+	for( uint32_t batch = 0; leaks_privacy && !is_complete(); ++batch ) {
+		double timestamps[ 4 ];
+		timestamps[ 0 ] = log_timestamp();
+		const uint32_t num_edges_before = m_;
+
+		/* Draw a batch of candidate edges in the same order in which 
+		 * add_random_edge() would draw them. */
+		for( auto &e : candidates ) {
+			e.first = rand() % n_;
+			e.second = rand() % n_;
+		}
+
+		/* Concurrently discard candidates that are already in the graph. */
+#pragma omp parallel for
+		for( uint32_t i = 0; i < HOPEFUL_BATCH_SIZE; ++i ) {
+			is_new[ i ] = candidates[ i ].first != candidates[ i ].second && 
+				adjacency_list_[ candidates[ i ].first ].count( candidates[ i ].second ) == 0;
+		}
+
+		/* Insert the rest one by one (skipping repeats within the batch), 
+		 * stopping at the first edge after which the graph is alpha-proximal. */
+		for( uint32_t i = 0; i < HOPEFUL_BATCH_SIZE && leaks_privacy && !is_complete(); ++i ) {
+			if( is_new[ i ] && add_edge( candidates[ i ].first, candidates[ i ].second ) ) {
+				leaks_privacy = !tracker_->is_alpha_proximal();
+			}
+		}
+
+		/* Each insertion is checked in O(1) by the tracker, so the checks count towards the step. */
+		timestamps[ 1 ] = timestamps[ 2 ] = timestamps[ 3 ] = log_timestamp();
+		log_iteration( alpha, batch, m_ - num_edges_before, 0, timestamps );
+	}
+	untrack_alpha_proximity();
+}
+
+template < class Metric >
+uint32_t LabelledGraph::run_greedy_iteration( Rational const& alpha ) {
+
+	const uint32_t num_attributes = alphabet_sizes_.size();
+	std::vector< std::vector< std::pair< uint32_t, LabelSet > > > visit_orders( num_attributes );
+	std::vector< std::vector< uint32_t > > bucket_starts( num_attributes );
+	std::vector< std::vector< uint32_t > > all_mates( num_attributes );
+	std::vector< std::vector< char > > all_lacking( num_attributes );
+	std::vector< std::pair< uint32_t, uint32_t > > label_pairs; /* ( attribute, pair ) */
+	std::vector< uint32_t > num_chunks; /* of each label pair */
+
+	for( uint32_t attribute = 0; attribute < num_attributes; ++attribute ) {
+		const uint32_t num_labels = alphabet_sizes_[ attribute ];
+		std::vector< uint32_t > const& labels = vertex_labels_[ attribute ];
+		std::vector< std::pair< uint32_t, LabelSet > > &visit_order = visit_orders[ attribute ];
+		LabelDistribution *global;
+
+		get_global_ld( attribute, &global );
+
+		/* First determine concurrently which "partition" each vertex belongs to. */
+		std::vector< LabelSet > deficiencies( n_ );
+		compute_neighbourhood_distances< Metric >( attribute, global, NULL, &alpha, &deficiencies );
+		delete global;
+
+		/* If vertex i is already alpha-proximal, exclude it
+		 * from further processing. */
+		for( uint32_t i = 0; i < n_; ++i ) {
+			if( deficiencies[ i ].any() ) {
+				visit_order.push_back ( std::make_pair( i, std::move( deficiencies[ i ] ) ) );
+			}
+		}
+
+		/* Randomize the order of the points so that edges are added more
+		 * "evenly." */
+		std::random_shuffle( visit_order.begin(), visit_order.end() );
+
+		/* Index the deficient vertices by (own label, deficient label) in buckets, 
+		 * each of which lists positions in visit_order in increasing order. A 
+		 * vertex with label l that is deficient in label l' appears in bucket 
+		 * l * num_labels + l'. */
+		const uint32_t num_buckets = num_labels * num_labels;
+		std::vector< uint32_t > &bucket_start = bucket_starts[ attribute ];
+		bucket_start.assign( num_buckets + 1, 0 );
+		for( auto const& entry : visit_order ) {
+			const uint32_t first_bucket = labels[ entry.first ] * num_labels;
+			for( uint32_t l = entry.second.find_first(); l != NO_LABEL; l = entry.second.find_next( l + 1 ) ) {
+				++bucket_start[ first_bucket + l + 1 ];
+			}
+		}
+		std::partial_sum( bucket_start.begin(), bucket_start.end(), bucket_start.begin() );
+
+		std::vector< uint32_t > &mates = all_mates[ attribute ];
+		mates.resize( bucket_start.back() );
+		std::vector< uint32_t > bucket_head( bucket_start.begin(), bucket_start.end() - 1 );
+		for( uint32_t pos = 0; pos < visit_order.size(); ++pos ) {
+			const uint32_t first_bucket = labels[ visit_order[ pos ].first ] * num_labels;
+			LabelSet const& defs = visit_order[ pos ].second;
+			for( uint32_t l = defs.find_first(); l != NO_LABEL; l = defs.find_next( l + 1 ) ) {
+				mates[ bucket_head[ first_bucket + l ]++ ] = pos;
+			}
+		}
+
+		all_lacking[ attribute ].assign( mates.size(), 1 );
+
+		/* Split the label pairs with many deficient vertices into chunks of 
+		 * visit_order, which are roughly balanced because it is shuffled. */
+		for( uint32_t pair = 0; pair < num_buckets; ++pair ) {
+			const uint32_t a = pair / num_labels, b = pair % num_labels;
+			if( a > b ) { continue; }
+			uint32_t pair_size = bucket_start[ pair + 1 ] - bucket_start[ pair ];
+			if( a != b ) { pair_size += bucket_start[ b * num_labels + a + 1 ] - bucket_start[ b * num_labels + a ]; }
+			label_pairs.push_back( std::make_pair( attribute, pair ) );
+			num_chunks.push_back( ( pair_size + GREEDY_PAIR_CHUNK_SIZE - 1 ) / GREEDY_PAIR_CHUNK_SIZE );
+		}
+	}
+
+	/* Process each deficient point v with label l1 by, for each deficient label
+	 * l2, finding a mate u with label l2 who is deficient in l1 and comes 
+	 * later in visit_order, and adding edge (u,v) to the graph (if it can be done).
+	 * 
+	 * Such an edge only resolves deficiencies of l1 vertices in l2 and of l2 
+	 * vertices in l1, and only l1-l2 edges can block it, so the matching of 
+	 * each unordered label pair is independent of the others and is computed 
+	 * concurrently against the unmodified graph. (Within a pair, a mate whose 
+	 * deficiency was resolved is never chosen again, so no edge is proposed 
+	 * twice.) The label pairs of all attributes are matched together, and their 
+	 * edges are then inserted all at once.
+	 * 
+	 * So that a few large label pairs do not serialise the iteration, each 
+	 * chunk of a large pair is first matched on its own, with mates from the 
+	 * same chunk only. Since the chunks are disjoint ranges of visit_order, 
+	 * no two of them share a vertex, and so no two can propose conflicting 
+	 * edges. A second pass over the whole pair then matches the vertices that 
+	 * are left without a mate in their chunk, just as the first pass would 
+	 * have. (A pair of one chunk is done after the first pass.)
+	 */
+	std::vector< std::pair< uint32_t, uint32_t > > chunks; /* ( label pair, chunk ) */
+	for( uint32_t i = 0; i < label_pairs.size(); ++i ) {
+		for( uint32_t c = 0; c < num_chunks[ i ]; ++c ) { chunks.push_back( std::make_pair( i, c ) ); }
+	}
+	std::vector< EdgeList > pair_edges( chunks.size() + label_pairs.size() );
+#pragma omp parallel for schedule( dynamic )
+	for( uint32_t k = 0; k < chunks.size(); ++k ) {
+		const uint32_t i = chunks[ k ].first, c = chunks[ k ].second;
+		const uint32_t attribute = label_pairs[ i ].first, num_labels = alphabet_sizes_[ attribute ];
+		const uint64_t num_positions = visit_orders[ attribute ].size();
+		match_label_pair( attribute, label_pairs[ i ].second / num_labels, label_pairs[ i ].second % num_labels, 
+			visit_orders[ attribute ], bucket_starts[ attribute ], all_mates[ attribute ], 
+			num_positions * c / num_chunks[ i ], num_positions * ( c + 1 ) / num_chunks[ i ], 
+			&all_lacking[ attribute ], &pair_edges[ k ] );
+	}
+#pragma omp parallel for schedule( dynamic )
+	for( uint32_t i = 0; i < label_pairs.size(); ++i ) {
+		if( num_chunks[ i ] < 2 ) { continue; }
+		const uint32_t attribute = label_pairs[ i ].first, num_labels = alphabet_sizes_[ attribute ];
+		match_label_pair( attribute, label_pairs[ i ].second / num_labels, label_pairs[ i ].second % num_labels, 
+			visit_orders[ attribute ], bucket_starts[ attribute ], all_mates[ attribute ], 
+			0, visit_orders[ attribute ].size(), &all_lacking[ attribute ], &pair_edges[ chunks.size() + i ] );
+	}
+
+	return insert_proposed_edges( pair_edges );
+}
+
+template < class Metric >
+void LabelledGraph::greedy( Rational const& alpha ) {
+	iterate_until_alpha_proximal< Metric, &LabelledGraph::run_greedy_iteration< Metric > >( alpha );
+}
+
+template < class Metric, uint32_t ( LabelledGraph::*Step )( Rational const& ) >
+void LabelledGraph::iterate_until_alpha_proximal( Rational const& alpha ) {
+	track_alpha_proximity< Metric >( alpha );
+	std::vector< std::vector< std::vector< uint32_t > > > members( alphabet_sizes_.size() );
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		group_by_label( attribute, &members[ attribute ] );
+	}
+
+	/* The sampler stays valid across consecutive fallbacks, since only they change the graph. */
+	DeficiencySampler *sampler = NULL;
+	bool leaks_privacy = !is_alpha_proximal< Metric >( alpha );
+	for( uint32_t iteration = 0; leaks_privacy && !is_complete(); ++iteration ) {
+		double timestamps[ 4 ];
+		timestamps[ 0 ] = log_timestamp();
+		const uint32_t num_new_edges = ( this->*Step )( alpha );
+		const uint32_t num_edges_before_fallback = m_;
+		timestamps[ 1 ] = log_timestamp();
+		leaks_privacy = !is_alpha_proximal< Metric >( alpha );
+		timestamps[ 2 ] = log_timestamp();
+		if( leaks_privacy && num_new_edges == 0 ) { add_fallback_edges< Metric >( alpha, &sampler, members ); }
+		else if( leaks_privacy ) {
+			delete sampler;
+			sampler = NULL;
+		}
+		timestamps[ 3 ] = log_timestamp();
+		log_iteration( alpha, iteration, num_new_edges, m_ - num_edges_before_fallback, timestamps );
+	}
+	delete sampler;
+	untrack_alpha_proximity();
+}
+
+template < class Metric >
+void LabelledGraph::compute_demands( const uint32_t attribute, LabelDistribution const* global, 
+	Rational const& alpha, std::vector< uint32_t > *demands ) const {
+
+	const uint32_t num_labels = alphabet_sizes_[ attribute ];
+	uint32_t const* global_counts = global->get_counts();
+	const uint32_t global_sum = global->get_sum();
+	demands->assign( static_cast< size_t >( n_ ) * num_labels, 0 );
+
+#pragma omp parallel
+	{
+		std::vector< uint32_t > counts( num_labels );
+
+#pragma omp for schedule( dynamic, 256 )
+		for( uint32_t v = 0; v < n_; ++v ) {
+			uint32_t const* row = get_neighbourhood_counts( attribute, v );
+			uint32_t *demand = demands->data() + static_cast< size_t >( v ) * num_labels;
+			uint32_t sum = adjacency_list_[ v ].size() + 1;
+			counts.assign( row, row + num_labels );
+
+			while( Metric::distance( counts.data(), sum, global_counts, global_sum, num_labels ) > alpha ) {
+
+				/* Demand the most under-represented label that has vertices to spare. */
+				uint32_t best = NO_LABEL;
+				int64_t best_diff = 0;
+				for( uint32_t i = 0; i < num_labels; ++i ) {
+					const int64_t pairwise_diff = pairwise_difference( counts[ i ], sum, global_counts[ i ], global_sum );
+					if( counts[ i ] < global_counts[ i ] && ( best == NO_LABEL || pairwise_diff < best_diff ) ) {
+						best = i;
+						best_diff = pairwise_diff;
+					}
+				}
+				if( best == NO_LABEL ) { break; } /* the neighbourhood is everything. */
+				++counts[ best ];
+				++sum;
+				++demand[ best ];
+			}
+		}
+	}
+}
+
+template < class Metric >
+uint32_t LabelledGraph::run_flow_iteration( Rational const& alpha ) {
+
+	const uint32_t num_attributes = alphabet_sizes_.size();
+	std::vector< LabelDistribution* > globals( num_attributes );
+	std::vector< std::vector< uint32_t > > demands( num_attributes );
+	std::vector< std::vector< std::vector< uint32_t > > > members( num_attributes );
+	std::vector< std::pair< uint32_t, uint32_t > > label_pairs; /* ( attribute, pair ) */
+
+	for( uint32_t attribute = 0; attribute < num_attributes; ++attribute ) {
+		const uint32_t num_labels = alphabet_sizes_[ attribute ];
+		get_global_ld( attribute, &globals[ attribute ] );
+		compute_demands< Metric >( attribute, globals[ attribute ], alpha, &demands[ attribute ] );
+
+		group_by_label( attribute, &members[ attribute ] );
+		for( uint32_t pair = 0; pair < num_labels * num_labels; ++pair ) {
+			if( pair / num_labels <= pair % num_labels ) { label_pairs.push_back( std::make_pair( attribute, pair ) ); }
+		}
+	}
+
+	/* As in run_greedy_iteration(), the edges of each label pair only touch 
+	 * demands between its two labels, so the pairs are matched concurrently. */
+	std::vector< EdgeList > pair_edges( label_pairs.size() );
+#pragma omp parallel for schedule( dynamic )
+	for( uint32_t i = 0; i < label_pairs.size(); ++i ) {
+		const uint32_t attribute = label_pairs[ i ].first, num_labels = alphabet_sizes_[ attribute ];
+		match_demands( attribute, label_pairs[ i ].second / num_labels, label_pairs[ i ].second % num_labels, 
+			globals[ attribute ], demands[ attribute ], members[ attribute ], &pair_edges[ i ] );
+	}
+
+	for( auto global : globals ) { delete global; }
+	return insert_proposed_edges( pair_edges );
+}
+
+template < class Metric >
+void LabelledGraph::flow_matching( Rational const& alpha ) {
+	iterate_until_alpha_proximal< Metric, &LabelledGraph::run_flow_iteration< Metric > >( alpha );
+}
+
+template < class Metric >
+DeficiencySampler* LabelledGraph::make_deficiency_sampler( Rational const& alpha ) const {
+	std::vector< Deficiency > deficiencies;
+	std::vector< double > weights;
+	std::vector< Rational > distances( n_ );
+
+	for( uint32_t attribute = 0; attribute < alphabet_sizes_.size(); ++attribute ) {
+		const uint32_t num_labels = alphabet_sizes_[ attribute ];
+		LabelDistribution const* global = tracked_global_lds_[ attribute ];
+		compute_neighbourhood_distances< Metric >( attribute, global, &distances, NULL, NULL );
+
+		for( uint32_t v = 0; v < n_; ++v ) {
+			if( !( distances[ v ] > alpha ) ) { continue; }
+			uint32_t const* counts = get_neighbourhood_counts( attribute, v );
+			const uint32_t sum = adjacency_list_[ v ].size() + 1;
+			for( uint32_t i = 0; i < num_labels; ++i ) {
+				const int64_t pairwise_diff = pairwise_difference( counts[ i ], sum, 
+					global->get_counts()[ i ], global->get_sum() );
+				if( pairwise_diff < 0 ) {
+					deficiencies.push_back( Deficiency{ v, attribute, i } );
+					weights.push_back( -pairwise_diff / ( static_cast< double >( sum ) * global->get_sum() ) );
+				}
+			}
+		}
+	}
+	return new DeficiencySampler( deficiencies, weights );
+}
+
+template < class Metric >
+bool LabelledGraph::add_targeted_edge( Rational const& alpha, DeficiencySampler *sampler, 
+	std::vector< std::vector< std::vector< uint32_t > > > const& members ) {
+
+	std::vector< uint32_t > counts;
+	while( !sampler->empty() ) {
+		const uint32_t i = sampler->sample();
+		Deficiency const d = sampler->get( i );
+		const uint32_t num_labels = alphabet_sizes_[ d.attribute ];
+		LabelDistribution const* global = tracked_global_lds_[ d.attribute ];
+		uint32_t const* global_counts = global->get_counts();
+		uint32_t const* row = get_neighbourhood_counts( d.attribute, d.vertex );
+		const uint32_t sum = adjacency_list_[ d.vertex ].size() + 1;
+
+		/* Discard the deficiency if it has cleared, or if one more neighbour 
+		 * with the label would not bring the vertex closer. */
+		counts.assign( row, row + num_labels );
+		++counts[ d.label ];
+		const Rational distance = Metric::distance( row, sum, global_counts, global->get_sum(), num_labels );
+		if( !( distance > alpha ) || 
+			pairwise_difference( row[ d.label ], sum, global_counts[ d.label ], global->get_sum() ) >= 0 || 
+			!( Metric::distance( counts.data(), sum + 1, global_counts, global->get_sum(), num_labels ) < distance ) ) {
+			sampler->remove( i );
+			continue;
+		}
+
+		/* Find a partner with the label, preferably one that lacks the vertex's own label. */
+		std::vector< uint32_t > const& candidates = members[ d.attribute ][ d.label ];
+		const uint32_t own_label = vertex_labels_[ d.attribute ][ d.vertex ];
+		const uint32_t num_candidates = candidates.size(), start = rand() % num_candidates;
+		uint32_t partner = n_, first = 0;
+		for( uint32_t k = 0; k < num_candidates; ++k ) {
+			const uint32_t u = candidates[ ( start + k ) % num_candidates ];
+			if( u == d.vertex || adjacency_list_[ d.vertex ].count( u ) > 0 ) { continue; }
+			if( partner == n_ ) { partner = u; first = k; }
+			if( pairwise_difference( get_neighbourhood_counts( d.attribute, u )[ own_label ], 
+				adjacency_list_[ u ].size() + 1, global_counts[ own_label ], global->get_sum() ) < 0 ) {
+				partner = u;
+				break;
+			}
+
+			/* Once a partner is found, only look a little further for a better one. */
+			if( k >= first + DEFICIENCY_PARTNER_SCAN ) { break; }
+		}
+
+		/* Every vertex with the label is a neighbour already. */
+		if( partner == n_ ) {
+			sampler->remove( i );
+			continue;
+		}
+		return add_edge( d.vertex, partner );
+	}
+	return false;
+}
+
+template < class Metric >
+void LabelledGraph::add_fallback_edges( Rational const& alpha, DeficiencySampler **sampler, 
+	std::vector< std::vector< std::vector< uint32_t > > > const& members ) {
+
+	if( *sampler == NULL ) { *sampler = make_deficiency_sampler< Metric >( alpha ); }
+	const uint32_t num_deficient = tracker_->num_deficient();
+	while( tracker_->num_deficient() >= num_deficient && !is_complete() ) {
+		if( add_targeted_edge< Metric >( alpha, *sampler, members ) ) { continue; }
+
+		/* The sampler ran empty, but vertices (e.g., earlier partners) may have 
+		 * become deficient since it was built, so rebuild it before giving up. */
+		delete *sampler;
+		*sampler = make_deficiency_sampler< Metric >( alpha );
+		if( !add_targeted_edge< Metric >( alpha, *sampler, members ) ) {
+			add_random_edge();
+			return;
+		}
+	}
+}
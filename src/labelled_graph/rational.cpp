@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief Implementation of the Rational struct in rational.h
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>	/* for uint64_t */
+#include <cctype>	/* for isdigit */
+
+#include "rational.h" /* implementing this struct. */
+
+/**
+ * Parses an unsigned integer of up to 18 digits.
+ * @param text The string to parse, which is advanced past the digits.
+ * @param value The address at which to store the parsed integer.
+ * @return True if at least one digit was read and the integer fits.
+ */
+static bool parse_integer( const char **text, uint64_t *value ) {
+	const char *start = *text;
+	*value = 0;
+	while( isdigit( **text ) ) {
+		if( *text - start == 18 ) { return false; }
+		*value = *value * 10 + ( **text - '0' );
+		++( *text );
+	}
+	return *text != start;
+}
+
+bool Rational::parse( const char *text, Rational *value ) {
+	uint64_t whole = 0;
+	const bool has_whole = parse_integer( &text, &whole );
+
+	/* A fraction p/q. */
+	if( has_whole && *text == '/' ) {
+		++text;
+		if( !parse_integer( &text, &value->denominator ) || value->denominator == 0 ) { return false; }
+		value->numerator = whole;
+		return *text == '\0';
+	}
+
+	/* A decimal, of which the fractional digits beyond the 18th are dropped. */
+	value->numerator = whole;
+	value->denominator = 1;
+	bool has_fraction = false;
+	if( *text == '.' ) {
+		for( ++text; isdigit( *text ); ++text, has_fraction = true ) {
+			if( value->denominator > UINT64_C( 100000000000000000 ) ) { continue; }
+			if( value->numerator > ( UINT64_MAX - 9 ) / 10 ) { return false; }
+			value->numerator = value->numerator * 10 + ( *text - '0' );
+			value->denominator *= 10;
+		}
+	}
+	return ( has_whole || has_fraction ) && *text == '\0';
+}
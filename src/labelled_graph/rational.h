@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Definition of an exact non-negative rational number, used for the 
+ * privacy threshold alpha and for distances between LabelDistributions.
+ *
+ * @copyright Copyright (c) 2015 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RATIONAL_H_
+#define RATIONAL_H_
+
+#include <cstdint>	/* for uint64_t */
+
+/**
+ * @brief A non-negative rational number with a 64-bit numerator and 
+ * denominator, compared exactly by cross-multiplication in 128 bits.
+ */
+struct Rational {
+	uint64_t numerator; /**< The numerator. */
+	uint64_t denominator; /**< The denominator, which must be positive. */
+
+	/**
+	 * Parses a rational number from a decimal (e.g., "0.1") or a 
+	 * fraction (e.g., "1/3"), without any rounding.
+	 * @param text The string to parse.
+	 * @param value The address at which to store the parsed number.
+	 * @return True if text was a valid non-negative number. Decimal digits 
+	 * beyond the 18th after the point are ignored.
+	 */
+	static bool parse( const char *text, Rational *value );
+
+	/**
+	 * Approximates the rational number as a float, e.g., for printing.
+	 * @return The nearest float to numerator / denominator.
+	 */
+	float to_float() const { return numerator / static_cast< double >( denominator ); }
+
+	/**
+	 * Compares two rational numbers exactly.
+	 * @param other The rational number to compare against.
+	 * @return True if this is strictly less than other.
+	 */
+	bool operator<( Rational const& other ) const {
+		return static_cast< unsigned __int128 >( numerator ) * other.denominator 
+			< static_cast< unsigned __int128 >( other.numerator ) * denominator;
+	}
+
+	/** @return True if this is strictly greater than other. @see operator<() */
+	bool operator>( Rational const& other ) const { return other < *this; }
+
+	/** @return True if this is at most other. @see operator<() */
+	bool operator<=( Rational const& other ) const { return !( other < *this ); }
+
+	/** @return True if this and other are the same number. @see operator<() */
+	bool operator==( Rational const& other ) const { return !( *this < other ) && !( other < *this ); }
+};
+
+#endif /* RATIONAL_H_ */
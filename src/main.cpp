@@ -28,15 +28,22 @@
  */
 
 #include <iostream>		/* For std::cout, std::endl */
-#include <algorithm>	/* For std::find */
+#include <algorithm>	/* For std::find, std::replace, std::stable_sort */
 #include <string.h>		/* For strcmp() */
+#include <sstream>		/* For std::istringstream */
+#include <string>		/* For std::to_string */
+#include <omp.h>		/* For omp_get_wtime() */
 
 #include "labelled_graph/labelled_graph.h"
 #include "unlabelled_graph/unlabelled_graph.h"
 #include "labelled_graph/label_distribution.test.h"
+#include "labelled_graph/flow_network.test.h"
+#include "labelled_graph/deficiency_sampler.test.h"
+#include "unlabelled_graph/unlabelled_graph.test.h"
 
 /* STL containers in use */
 #include <map>
+#include <vector>
 
 /**
  * Finds a specified option among the command line arguments
@@ -60,6 +67,114 @@ char* getCmdOption(char **begin, char **end, const std::string &option, bool has
     return 0;
 }
 
+/**
+ * Parses a comma-separated list of privacy thresholds (e.g., "2,5,10") 
+ * or of other positive integers, such as alphabet sizes.
+ * @param list The command line argument containing the list.
+ * @param distinct Whether to drop repeats of a value given earlier in the 
+ * list, as for thresholds (but not for alphabet sizes, which may repeat).
+ * @returns The thresholds in the order in which they were (first) given, 
+ * or an empty list if any of them is not a positive integer.
+ */
+std::vector< uint32_t > parse_thresholds( const char *list, const bool distinct = false ) {
+	std::vector< uint32_t > thresholds;
+	std::istringstream iss( list );
+	std::string token;
+	while( std::getline( iss, token, ',' ) ) {
+		const int threshold = atoi( token.c_str() );
+		if( threshold <= 0 ) { return std::vector< uint32_t >(); }
+		if( distinct && std::find( thresholds.cbegin(), thresholds.cend(), threshold ) != thresholds.cend() ) { continue; }
+		thresholds.push_back( threshold );
+	}
+	return thresholds;
+}
+
+/**
+ * Parses a comma-separated list of attribute privacy thresholds, each a 
+ * decimal or a fraction (e.g., "0.3,1/5,0.1").
+ * @param list The command line argument containing the list.
+ * @param alphas The vector in which to store the distinct thresholds, in 
+ * the order in which they were first given (so "0.2,1/5" yields only 0.2).
+ * @param texts The vector in which to store the text of each threshold.
+ * @returns True if every threshold could be parsed.
+ */
+bool parse_alphas( const char *list, std::vector< Rational > *alphas, std::vector< std::string > *texts ) {
+	std::istringstream iss( list );
+	std::string token;
+	while( std::getline( iss, token, ',' ) ) {
+		Rational alpha;
+		if( !Rational::parse( token.c_str(), &alpha ) ) { return false; }
+		if( std::find( alphas->cbegin(), alphas->cend(), alpha ) != alphas->cend() ) { continue; }
+		alphas->push_back( alpha );
+		texts->push_back( token );
+	}
+	return !alphas->empty();
+}
+
+/**
+ * Writes a GraphDelta in the edgeList format: the first line gives the 
+ * number of vertices in the supergraph and each subsequent line gives one 
+ * new edge. The supergraph is the union of the original graph and this file.
+ * @param filename The path of the file to write.
+ * @param num_vertices The number of vertices in the original graph.
+ * @param delta The GraphDelta to write.
+ */
+void write_delta( std::string const& filename, const uint32_t num_vertices, 
+	GraphDelta const& delta ) {
+	
+	std::ofstream outfile;
+	outfile.open( filename );
+	outfile << num_vertices + delta.num_new_vertices << std::endl;
+	for( auto const& e : delta.new_edges ) {
+		outfile << e.first << " " << e.second << std::endl;
+	}
+	outfile.close();
+}
+
+/**
+ * Echoes to stderr every degree that violates k-degree-anonymity.
+ * @param violations A map from each violating degree to the number 
+ * of vertices that have it.
+ * @param k The privacy threshold, k.
+ * @see UnlabelledGraph::anonymity_violations()
+ */
+void print_violations( std::map< uint32_t, uint32_t > const& violations, const uint32_t k ) {
+	uint64_t num_vertices = 0;
+	for( auto const& violation : violations ) {
+		std::cerr << "\tdegree " << violation.first << ": " 
+			<< violation.second << " vertices" << std::endl;
+		num_vertices += violation.second;
+	}
+	std::cerr << violations.size() << " degrees (" << num_vertices << " vertices) "
+		<< "are shared by fewer than " << k << " vertices." << std::endl;
+}
+
+/**
+ * Echoes to stdout the k-neighbourhood anonymity of a graph, i.e., the 
+ * size of its smallest class of vertices with isomorphic neighbourhoods, 
+ * followed by the full histogram of class sizes, and then the anonymity 
+ * and number of classes at each depth of colour refinement.
+ * @param g The graph to audit.
+ * @param description A name for g to prefix the output with.
+ * @see UnlabelledGraph::neighbourhood_classes()
+ */
+void print_neighbourhood_audit( UnlabelledGraph const *g, std::string const& description ) {
+	ClassSizeHistogram const histogram = class_size_histogram( g->neighbourhood_classes() );
+	std::cout << description << " neighbourhood anonymity: " 
+		<< ( histogram.empty() ? 0 : histogram.begin()->first ) << std::endl;
+	std::cout << description << " class sizes: ";
+	for( auto const& bucket : histogram ) { std::cout << bucket.first << ":" << bucket.second << " "; }
+	std::cout << std::endl;
+	
+	std::vector< ClassSizeHistogram > const profile = g->colour_refinement_profile();
+	for( uint32_t depth = 0; depth < profile.size(); ++depth ) {
+		uint64_t num_classes = 0;
+		for( auto const& bucket : profile[ depth ] ) { num_classes += bucket.second / bucket.first; }
+		std::cout << description << " refinement depth " << depth << " anonymity: " 
+			<< ( profile[ depth ].empty() ? 0 : profile[ depth ].begin()->first ) 
+			<< " classes: " << num_classes << std::endl;
+	}
+}
 
 void print_usage_instructions( const char *bin_path ) {
 	std::cout << "Usage: "
@@ -71,28 +186,55 @@ void print_usage_instructions( const char *bin_path ) {
 	std::cout << "\t\t[-format {adjList, edgeList, adjListVL} [format to read/write "
 		<< "input/output files (adjList by default)]]" << std::endl;
 	std::cout << "\t\t[-o [path to output file]]" << std::endl;
-	std::cout << "\t\t[-k [identity privacy threshold]]" << std::endl;
-	std::cout << "\t\t[-alpha [attribute privacy threshold]]" << std::endl;
+	std::cout << "\t\t[-k [identity privacy threshold, or a comma-separated list of them "
+		<< "(e.g., 2,5,10) to write one pseudo-vertex delta per threshold]]" << std::endl;
+	std::cout << "\t\t[-alpha [attribute privacy threshold, as a decimal or a fraction (e.g., 1/3), or a "
+		<< "comma-separated list of them (e.g., 0.3,0.2,0.1) to tighten one graph threshold by threshold]]" << std::endl;
+	std::cout << "\t\t[-algorithm {greedy,hopeful,flow} [alpha-proximity algorithm (greedy by default); flow adds "
+		<< "near-minimally many edges and reports its new edges and runtime against greedy]]" << std::endl;
+	std::cout << "\t\t[-metric {l1,emd,max,kl} [distance between label distributions: L1 (default), Earth Mover's "
+		<< "for ordinal labels, max-norm, or KL divergence]]" << std::endl;
+	std::cout << "\t\t[-telemetry [path to which to write per-iteration convergence telemetry of the "
+		<< "alpha-proximity algorithm]]" << std::endl;
+	std::cout << "\t\t[-telemetry-format {csv,binary} [format of the telemetry (csv by default); binary "
+		<< "writes raw 64-byte IterationRecords, see convergence_log.h]]" << std::endl;
 	std::cout << "\t\t[-n [number of vertices in random graph]]" << std::endl;
 	std::cout << "\t\t[-occ [occupancy rate in random graph (i.e., percentage of possible edges)]]" << std::endl;
-	std::cout << "\t\t[-l [label set size in random graph]]" << std::endl;
+	std::cout << "\t\t[-l [label set size in random graph, or a comma-separated list of them "
+		<< "(e.g., 3,5,4) for one attribute per size]]" << std::endl;
+	std::cout << "\t\t[-seed [seed for the random labelling of the random graph (random by default)]]" << std::endl;
 	std::cout << "\t\t[-stats [enables printing of graph properties to stdout]]" << std::endl;
-	std::cout << "\t\t[-hide-additional [enables the anonymisation of newly added vertices]]" << std::endl << std::endl;
+	std::cout << "\t\t[-hide-additional [enables the anonymisation of newly added vertices]]" << std::endl;
+	std::cout << "\t\t[-placement {cyclic,utility} [how to attach vertices to new vertices: round-robin "
+		<< "(default) or preferring those that close triangles]]" << std::endl;
+	std::cout << "\t\t[-edges-only [anonymises by adding edges among existing vertices instead of adding vertices]]" << std::endl;
+	std::cout << "\t\t[-verify [only reports which degrees of the input graph violate k-anonymity]]" << std::endl;
+	std::cout << "\t\t[-audit [reports the k-neighbourhood and colour-refinement anonymity of the graph before and after anonymisation]]" << std::endl << std::endl;
 	std::cout << "\tNote that if an input file is specified, all random graph parametres are ignored. " << std::endl
 			<< "\tIf no input file is specified, -n, -occ, and -l are mandatory. " << std::endl
 			<< "\t-alpha, the privacy threshold, is always mandatory." << std::endl << std::endl;
 	std::cout << "\tExample usage:" << std::endl;
-	std::cout << "\t\t" << bin_path << " -mode attribute -alpha 0.10001 -f ./workloads/asonam11_example.adjList -o private_graph.adjList" << std::endl;
+	std::cout << "\t\t" << bin_path << " -mode attribute -alpha 0.1 -f ./workloads/asonam11_example.adjList -o private_graph.adjList" << std::endl;
 	std::cout << "\t\t" << bin_path << " -mode attribute -alpha 0.05 -n 100 -occ .01 -l 2" << std::endl << std::endl;
-	std::cout << "\t\t" << bin_path << " -mode identity -k 3 -f ./workloads/snam_example1.adjList -o anon_graph.adjList -stats" << std::endl << std::endl;
+	std::cout << "\t\t" << bin_path << " -mode identity -k 3 -f ./workloads/snam_example1.adjList -o anon_graph.adjList -stats" << std::endl;
+	std::cout << "\t\t" << bin_path << " -mode identity -k 2,3 -f ./workloads/snam_example2.adjList -o anon_graph" << std::endl << std::endl;
 	std::cout << "\tOutput:" << std::endl;
 	std::cout << "\t\tThe input graph is made alpha-secure from a neighbourhood attribute disclosure (NAD) " << std::endl;
 	std::cout << "\t\tattack. The extent to which the graph is modified is echoed to stdout in the form: " << std::endl;
-	std::cout << "\t\t[original occupancy] [final occupancy] [% change in occupancy]" << std::endl << std::endl;
-	std::cout << "\tWarning:" << std::endl;
-	std::cout << "\t\tThis software uses floating point values and some real values (e.g., 0.1) will be " << std::endl;
-	std::cout << "\t\tapproximated. You may wish to consider adding a small correction factor (e.g., 0.00001) "  << std::endl;
-	std::cout << "\t\tto your privacy threshold, alpha. " << std::endl << std::endl;
+	std::cout << "\t\t[original occupancy] [final occupancy] [% change in occupancy]" << std::endl;
+	std::cout << "\t\tWith a list of identity privacy thresholds, the number of new vertices and edges " << std::endl;
+	std::cout << "\t\tis echoed for each k and, if -o is given, the new edges are written in edgeList " << std::endl;
+	std::cout << "\t\tformat to [path to output file].k[k]. The anonymised graph is the union of the " << std::endl;
+	std::cout << "\t\tinput graph and that file. -stats is ignored in this case, and -audit reports the " << std::endl;
+	std::cout << "\t\tanonymised graph of each k." << std::endl;
+	std::cout << "\t\tWith a list of attribute privacy thresholds, the algorithm runs once per alpha, from " << std::endl;
+	std::cout << "\t\tthe largest to the smallest, on the same graph. The number of new edges is echoed " << std::endl;
+	std::cout << "\t\tfor each alpha and, if -o is given, the graph reached for it is written to " << std::endl;
+	std::cout << "\t\t[path to output file].alpha[alpha], with any / in alpha replaced by _." << std::endl << std::endl;
+	std::cout << "\tNote:" << std::endl;
+	std::cout << "\t\tAlpha and all label-distribution distances are compared exactly, as rational numbers, " << std::endl;
+	std::cout << "\t\tso no correction factor needs to be added to alpha. KL divergences are rounded to " << std::endl
+			<< "\t\tmultiples of 2^-32." << std::endl << std::endl;
 }
 
 /**
@@ -115,6 +257,49 @@ void inline print_stats( UnlabelledGraph *g ) {
 }
 
 
+/**
+ * Runs an alpha-proximity algorithm on a graph and verifies its result.
+ * @tparam Metric The proximity metric with which distances are measured.
+ * @param g The graph to make alpha-proximal.
+ * @param algorithm The name of the algorithm, or NULL for the default.
+ * @param alpha The privacy threshold.
+ * @returns 0 on success, 1 if the algorithm is unknown, and 2 if 
+ * the graph is not alpha-proximal afterwards.
+ */
+template < class Metric >
+uint32_t make_alpha_proximal( LabelledGraph *g, const char *algorithm, Rational const& alpha ) {
+	if( algorithm == NULL || strcmp( algorithm, "greedy" ) == 0 ) { g->greedy< Metric >( alpha ); }
+	else if( strcmp( algorithm, "hopeful" ) == 0 ) { g->hopeful< Metric >( alpha ); }
+	else if( strcmp( algorithm, "flow" ) == 0 ) {
+
+		/* Also run greedy on a copy of the input, to report both side by side. */
+		LabelledGraph *reference = g->clone();
+		const uint32_t num_edges = g->num_edges();
+		double start = omp_get_wtime();
+		g->flow_matching< Metric >( alpha );
+		const double flow_time = omp_get_wtime() - start;
+		start = omp_get_wtime();
+		reference->greedy< Metric >( alpha );
+		const double greedy_time = omp_get_wtime() - start;
+		std::cout << "flow: " << g->num_edges() - num_edges << " new edges in " << flow_time << " s" << std::endl;
+		std::cout << "greedy: " << reference->num_edges() - num_edges << " new edges in " << greedy_time << " s" << std::endl;
+		delete reference;
+	}
+	else {
+		std::cerr << std::endl
+			<< "\tAlgorithm \"" << algorithm << "\" not supported. "
+			<< "Please try \"greedy\", \"hopeful\", or \"flow\" instead." << std::endl;
+		return 1;
+	}
+	if( !g->is_alpha_proximal< Metric >( alpha ) ) {
+		std::cerr << "This instance was evidently not solved. ";
+		std::cerr << "The software must have a bug? ";
+		std::cerr << "You should contact the developer.";
+		return 2;
+	}
+	return 0;
+}
+
 /**
  * Runs the software to create a alpha-proximal graph, 
  * according to command-line specifications.
@@ -131,12 +316,15 @@ uint32_t run_attribute_mode( int argc, char** argv ) {
 	LabelledGraph *g;
 
 	char *filename = getCmdOption( argv, argv + argc, "-f", true );
-	char *alpha = getCmdOption( argv, argv + argc, "-alpha", true );
-	if( alpha == 0 ) {
+	char *alpha_text = getCmdOption( argv, argv + argc, "-alpha", true );
+	std::vector< Rational > alphas;
+	std::vector< std::string > alpha_texts;
+	if( alpha_text == 0 || !parse_alphas( alpha_text, &alphas, &alpha_texts ) ) {
 
 		//print_usage_instructions( *argv );
 		std::cerr << std::endl
-				<< "\tYou must specify a value for alpha (e.g., -alpha 0.1)"
+				<< "\tYou must specify a value for alpha as a decimal or a fraction "
+				<< "(e.g., -alpha 0.1 or -alpha 1/3), or a comma-separated list of them"
 				<< std::endl;
 		return 1;
 	}
@@ -151,12 +339,14 @@ uint32_t run_attribute_mode( int argc, char** argv ) {
 		char *alphabet_size = getCmdOption( argv, argv + argc, "-l", true );
 		
 		size_t const n = atoi( graph_size );
-		size_t const l = atoi( alphabet_size );
+		std::vector< uint32_t > const alphabet_sizes = ( alphabet_size != NULL ? 
+			parse_thresholds( alphabet_size ) : std::vector< uint32_t >() );
 		float const occ = atof( occupancy );
 		
-		if( n > 0 && occ > 0 && l > 0 ) {
-			g = new LabelledGraph( n, l );
-			g->evenly_distribute_labels();
+		if( n > 0 && occ > 0 && !alphabet_sizes.empty() ) {
+			char *seed = getCmdOption( argv, argv + argc, "-seed", true );
+			g = new LabelledGraph( n, alphabet_sizes );
+			g->evenly_distribute_labels( seed != NULL ? strtoul( seed, NULL, 10 ) : rand() );
 			const uint32_t num_edges = occ * n * ( n - 1 ) / 2; /* 1/2 b/c undirected */
 			g->populate_uniformly( num_edges );
 		}
@@ -179,17 +369,89 @@ uint32_t run_attribute_mode( int argc, char** argv ) {
 		delete g;
 		return 2;
 	}
+	if( !test_max_flow() ) {
+		std::cerr << "Failed unit test of FlowNetwork" <<
+				" max_flow function! Aborting." << std::endl;
+				
+		delete g;
+		return 2;
+	}
+	if( !test_deficiency_sampler() ) {
+		std::cerr << "Failed unit test of DeficiencySampler" <<
+				" sample function! Aborting." << std::endl;
+				
+		delete g;
+		return 2;
+	}
 	
 
-	/* Execute algorithm. */
-	g->greedy( atof( alpha ) );
-	if( !g->is_alpha_proximal( atof( alpha ) ) ) {
-		std::cerr << "This instance was evidently not solved. ";
-		std::cerr << "The software must have a bug? ";
-		std::cerr << "You should contact the developer.";
-		
+	/* If requested, record the convergence of the algorithm. */
+	char *telemetry = getCmdOption( argv, argv + argc, "-telemetry", true );
+	ConvergenceLog *log = NULL;
+	if( telemetry != NULL ) {
+		char *telemetry_format = getCmdOption( argv, argv + argc, "-telemetry-format", true );
+		if( telemetry_format != NULL && strcmp( telemetry_format, "csv" ) != 0 && strcmp( telemetry_format, "binary" ) != 0 ) {
+			std::cerr << std::endl
+				<< "\tTelemetry format \"" << telemetry_format << "\" not supported. "
+				<< "Please try \"csv\" or \"binary\" instead." << std::endl;
+			delete g;
+			return 1;
+		}
+		log = new ConvergenceLog( telemetry, telemetry_format != NULL && strcmp( telemetry_format, "binary" ) == 0 );
+		if( !log->is_open() ) {
+			std::cerr << std::endl << "\tCould not open telemetry file \"" << telemetry << "\"." << std::endl;
+			delete log;
+			delete g;
+			return 1;
+		}
+		g->log_convergence( log );
+	}
+
+	/* Visit several thresholds from the loosest to the tightest, so that each 
+	 * run starts from the edges that the looser thresholds have added. */
+	std::vector< uint32_t > order( alphas.size() );
+	for( uint32_t i = 0; i < alphas.size(); ++i ) { order[ i ] = i; }
+	std::stable_sort( order.begin(), order.end(), 
+		[ &alphas ]( const uint32_t a, const uint32_t b ) { return alphas[ b ] < alphas[ a ]; } );
+	char *output_filename = getCmdOption( argv, argv + argc, "-o", true );
+
+	/* Execute algorithm with the requested metric, once per threshold. */
+	char *algorithm = getCmdOption( argv, argv + argc, "-algorithm", true );
+	char *metric = getCmdOption( argv, argv + argc, "-metric", true );
+	uint32_t result = 0;
+	for( uint32_t i = 0; i < order.size() && result == 0; ++i ) {
+		Rational const& alpha = alphas[ order[ i ] ];
+		const uint32_t num_edges = g->num_edges();
+		if( metric == NULL || strcmp( metric, "l1" ) == 0 ) { result = make_alpha_proximal< L1Distance >( g, algorithm, alpha ); }
+		else if( strcmp( metric, "emd" ) == 0 ) { result = make_alpha_proximal< EarthMoversDistance >( g, algorithm, alpha ); }
+		else if( strcmp( metric, "max" ) == 0 ) { result = make_alpha_proximal< MaxNormDistance >( g, algorithm, alpha ); }
+		else if( strcmp( metric, "kl" ) == 0 ) { result = make_alpha_proximal< KLDivergence >( g, algorithm, alpha ); }
+		else {
+			std::cerr << std::endl
+				<< "\tMetric \"" << metric << "\" not supported. "
+				<< "Please try \"l1\", \"emd\", \"max\", or \"kl\" instead." << std::endl;
+			result = 1;
+		}
+
+		/* Checkpoint the graph of each threshold of a sweep as soon as it is reached. */
+		if( result == 0 && alphas.size() > 1 ) {
+			std::cout << "alpha: " << alpha_texts[ order[ i ] ] 
+				<< " new edges: " << g->num_edges() - num_edges << std::endl;
+			if( output_filename != NULL ) {
+				std::string suffix = alpha_texts[ order[ i ] ];
+				std::replace( suffix.begin(), suffix.end(), '/', '_' ); /* e.g., 1/5 -> 1_5 */
+				std::ofstream outfile;
+				outfile.open( std::string( output_filename ) + ".alpha" + suffix );
+				outfile << *g;
+				outfile.close();
+			}
+		}
+	}
+	g->log_convergence( NULL );
+	delete log;
+	if( result != 0 ) {
 		delete g;
-		return 2;
+		return result;
 	}
 
 	/* If requested in command line args, echo to stdout the orig graph stats. */
@@ -198,8 +460,7 @@ uint32_t run_attribute_mode( int argc, char** argv ) {
 
 
 	/* If requested in command line args, write output Graph to file. */
-	char *output_filename = getCmdOption( argv, argv + argc, "-o", true );
-	if( output_filename != NULL ) {
+	if( output_filename != NULL && alphas.size() == 1 ) {
 		std::ofstream outfile;
 		outfile.open( output_filename );
 		outfile << *g;
@@ -231,13 +492,14 @@ uint32_t run_identity_mode( int argc, char** argv ) {
 	char *k = getCmdOption( argv, argv + argc, "-k", true );
 	
 	
-	if( k == 0 ) {
+	if( k == 0 || parse_thresholds( k ).empty() ) {
 
 		std::cerr << std::endl
-				<< "\tYou must specify a privacy threshold, k (e.g., -k 5)"
+				<< "\tYou must specify a privacy threshold, k (e.g., -k 5 or -k 2,5,10)"
 				<< std::endl;
 		return 1;
 	}
+	std::vector< uint32_t > const ks = parse_thresholds( k, true );
 	
 	if( filename != 0 ) {
 		char *format = getCmdOption( argv, argv + argc, "-format", true );
@@ -283,28 +545,139 @@ uint32_t run_identity_mode( int argc, char** argv ) {
 		assert( g != NULL );
 	}
 	
-	/* Determine whether or not all vertices should be hidden. */
+	/* Run unit tests first. */
+	if( !test_anonymize_degree_sequence() || !test_anonymize_degree_sequence_parallel() ) {
+		std::cerr << "Failed unit test of degree sequence" <<
+				" anonymisation! Aborting." << std::endl;
+				
+		delete g;
+		return 2;
+	}
+	
+	/* If requested, audit the neighbourhoods of the input graph. */
+	char *audit = getCmdOption( argv, argv + argc, "-audit", false );
+	if( audit != NULL ) { print_neighbourhood_audit( g, "original" ); }
+	
+	/* If requested, only check whether the input is already k-anonymous. */
+	if( getCmdOption( argv, argv + argc, "-verify", false ) != NULL ) {
+		uint32_t exit_code = 0;
+		for( auto const threshold : ks ) {
+			std::map< uint32_t, uint32_t > const violations = g->anonymity_violations( threshold );
+			if( violations.empty() ) {
+				std::cout << "The graph is " << threshold << "-degree-anonymous." << std::endl;
+			}
+			else {
+				print_violations( violations, threshold );
+				exit_code = 2;
+			}
+		}
+		
+		delete g;
+		return exit_code;
+	}
+	
+	/* Determine whether or not all vertices should be hidden, and how. */
 	char *hide_all = getCmdOption( argv, argv + argc, "-hide-additional", false );
+	graphAnon::PseudoVertexPlacement placement = graphAnon::PseudoVertexPlacement::cyclic;
+	char *placement_name = getCmdOption( argv, argv + argc, "-placement", true );
+	if( placement_name != NULL ) {
+		if( strcmp( placement_name, "utility" ) == 0 ) { placement = graphAnon::PseudoVertexPlacement::utility; }
+		else if( strcmp( placement_name, "cyclic" ) != 0 ) {
+			std::cerr << std::endl
+				<< "\tPlacement \"" << placement_name << "\" not supported. "
+				<< "Please try either \"cyclic\" or \"utility\" instead." << std::endl;
+			
+			delete g;
+			return 1;
+		}
+	}
+	char *output_filename = getCmdOption( argv, argv + argc, "-o", true );
+	
+	/* If requested, anonymise without adding any vertices. */
+	if( getCmdOption( argv, argv + argc, "-edges-only", false ) != NULL ) {
+		if( ks.size() > 1 || hide_all != NULL ) {
+			std::cerr << std::endl
+				<< "\t-edges-only supports neither a list of thresholds nor -hide-additional"
+				<< std::endl;
+			
+			delete g;
+			return 1;
+		}
+		g->supergraph_anonymize( ks.front() );
+		std::map< uint32_t, uint32_t > const violations = g->anonymity_violations( ks.front() );
+		if( !violations.empty() ) {
+			std::cerr << "This instance was evidently not solved. ";
+			std::cerr << "The software must have a bug? ";
+			std::cerr << "You should contact the developer." << std::endl;
+			print_violations( violations, ks.front() );
+			
+			delete g;
+			return 2;
+		}
+	}
+	
+	/* For several thresholds, only compute and write each one's delta. */
+	else if( ks.size() > 1 ) {
+		std::vector< GraphDelta > const deltas = ( hide_all != NULL ? 
+			g->hide_waldo_sweep< true >( ks, placement ) : g->hide_waldo_sweep< false >( ks, placement ) );
+		
+		for( uint32_t i = 0; i < ks.size(); ++i ) {
+			std::cout << "k: " << ks[ i ] 
+				<< " new vertices: " << deltas[ i ].num_new_vertices 
+				<< " new edges: " << deltas[ i ].new_edges.size() << std::endl;
+			
+			/* Check each delta (and audit it, if requested) on its own copy of the input. */
+			if( hide_all != NULL || audit != NULL ) {
+				UnlabelledGraph anonymised( *g );
+				anonymised.apply_delta( deltas[ i ] );
+				std::map< uint32_t, uint32_t > const violations = ( hide_all != NULL ? 
+					anonymised.anonymity_violations( ks[ i ] ) : std::map< uint32_t, uint32_t >() );
+				if( !violations.empty() ) {
+					std::cerr << "This instance was evidently not solved. ";
+					std::cerr << "Did you ensure k <= n?" << std::endl;
+					print_violations( violations, ks[ i ] );
+					
+					delete g;
+					return 2;
+				}
+				if( audit != NULL ) { 
+					print_neighbourhood_audit( &anonymised, "k " + std::to_string( ks[ i ] ) + " anonymised" ); 
+				}
+			}
+			
+			if( output_filename != NULL ) {
+				write_delta( std::string( output_filename ) + ".k" + std::to_string( ks[ i ] ), 
+					g->num_vertices(), deltas[ i ] );
+			}
+		}
+		
+		delete g;
+		return 0;
+	}
 	
 	/* Execute algorithm. */
-	if( hide_all != NULL ) {
-		g->hide_waldo< true >( atoi( k ) );
-		if( !g->is_anonymous( atoi( k ) ) ) {
+	else if( hide_all != NULL ) {
+		g->hide_waldo< true >( ks.front(), placement );
+		std::map< uint32_t, uint32_t > const violations = g->anonymity_violations( ks.front() );
+		if( !violations.empty() ) {
 			std::cerr << "This instance was evidently not solved. ";
 			std::cerr << "Did you ensure k <= n?" << std::endl;
+			print_violations( violations, ks.front() );
 		
 			delete g;
 			return 2;
 		}
 	}
-	else { g->hide_waldo< false >( atoi( k ) ); }
+	else { g->hide_waldo< false >( ks.front(), placement ); }
+	
+	/* If requested, audit the neighbourhoods of the anonymised graph. */
+	if( audit != NULL ) { print_neighbourhood_audit( g, "anonymised" ); }
 
 	/* If requested in command line args, echo to stdout the anon graph stats. */
 	char *stats = getCmdOption( argv, argv + argc, "-stats", false );
 	if( stats != NULL ) { print_stats( g ); }
 	
 	/* If requested in command line args, write output Graph to file. */
-	char *output_filename = getCmdOption( argv, argv + argc, "-o", true );
 	if( output_filename != NULL ) {
 		std::ofstream outfile;
 		outfile.open( output_filename );
@@ -0,0 +1,352 @@
+/**
+ * @file
+ * @brief Implementation of the neighbourhood anonymity audit of the UnlabelledGraph
+ * class in unlabelled_graph.h
+ * @see unlabelled_graph.cpp for the implementation of the remaining methods.
+ *
+ * @copyright Copyright (c) 2015-2017 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>		/* for uint32_t, uint64_t */
+#include <algorithm>	/* for std::sort, std::unique, std::binary_search */
+
+/* STL stuff in use. */
+#include <vector>
+#include <map>
+
+#include "unlabelled_graph.h" /* implementing this class. */
+
+namespace
+{
+	/** Marks a local vertex that has not (yet) been mapped or assigned. */
+	const uint32_t UNMAPPED = UINT32_MAX;
+	
+	/**
+	 * Mixes value into a running 64-bit hash, using the splitmix64 finaliser.
+	 */
+	uint64_t inline mix( const uint64_t hash, const uint64_t value ) {
+		uint64_t z = hash ^ ( value + 0x9e3779b97f4a7c15ull + ( hash << 6 ) + ( hash >> 2 ) );
+		z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+		return z ^ ( z >> 31 );
+	}
+	
+	/**
+	 * @brief The subgraph induced by the neighbours of a vertex, relabelled 
+	 * with local vertex ids 0..d-1 and annotated with refined vertex colours.
+	 */
+	struct Neighbourhood {
+		/** Sorted adjacency list of each local vertex. */
+		std::vector< std::vector< uint32_t > > adjacency;
+		/** Stable colour of each local vertex after colour refinement. */
+		std::vector< uint64_t > colours;
+		/** Number of edges in the neighbourhood. */
+		uint64_t num_edges;
+		/** Isomorphism-invariant hash of the neighbourhood. */
+		uint64_t invariant;
+	};
+	
+	/**
+	 * Extracts the neighbourhood of vertex v and computes its invariants.
+	 * @param adjacency_list The adjacency list of the whole graph.
+	 * @param v The vertex whose neighbourhood is extracted.
+	 * @param global_to_local Scratch space of size n in which every entry 
+	 * is UNMAPPED. It is restored to that state before returning.
+	 */
+	Neighbourhood extract_neighbourhood( AdjacencyList const& adjacency_list, 
+		const uint32_t v, std::vector< uint32_t > *global_to_local ) {
+		
+		Neighbourhood nbhd;
+		const uint32_t d = adjacency_list[ v ].size();
+		nbhd.adjacency.resize( d );
+		nbhd.num_edges = 0;
+		
+		/* Assign local ids to the neighbours of v. */
+		std::vector< uint32_t > local_to_global( adjacency_list[ v ].cbegin(), 
+			adjacency_list[ v ].cend() );
+		for( uint32_t i = 0; i < d; ++i ) { ( *global_to_local )[ local_to_global[ i ] ] = i; }
+		
+		/* Collect the induced edges, scanning whichever of adj(u) and N(v) is smaller. */
+		for( uint32_t i = 0; i < d; ++i ) {
+			NeighbourList const& neighbours = adjacency_list[ local_to_global[ i ] ];
+			if( neighbours.size() < d ) {
+				for( auto const w : neighbours ) {
+					if( ( *global_to_local )[ w ] != UNMAPPED ) {
+						nbhd.adjacency[ i ].push_back( ( *global_to_local )[ w ] );
+					}
+				}
+				std::sort( nbhd.adjacency[ i ].begin(), nbhd.adjacency[ i ].end() );
+			}
+			else {
+				for( uint32_t j = 0; j < d; ++j ) {
+					if( neighbours.count( local_to_global[ j ] ) > 0 ) { nbhd.adjacency[ i ].push_back( j ); }
+				}
+			}
+			nbhd.num_edges += nbhd.adjacency[ i ].size();
+		}
+		nbhd.num_edges /= 2;
+		for( auto const u : local_to_global ) { ( *global_to_local )[ u ] = UNMAPPED; }
+		
+		/* Refine colours, starting from local degrees, until the number of 
+		 * distinct colours stops growing. */
+		nbhd.colours.resize( d );
+		for( uint32_t i = 0; i < d; ++i ) { nbhd.colours[ i ] = nbhd.adjacency[ i ].size(); }
+		std::vector< uint64_t > sorted( nbhd.colours ), next( d ), neighbour_colours;
+		std::sort( sorted.begin(), sorted.end() );
+		uint32_t num_colours = std::unique( sorted.begin(), sorted.end() ) - sorted.begin();
+		while( num_colours < d ) {
+			for( uint32_t i = 0; i < d; ++i ) {
+				neighbour_colours.clear();
+				for( auto const j : nbhd.adjacency[ i ] ) { neighbour_colours.push_back( nbhd.colours[ j ] ); }
+				std::sort( neighbour_colours.begin(), neighbour_colours.end() );
+				next[ i ] = mix( 0, nbhd.colours[ i ] );
+				for( auto const c : neighbour_colours ) { next[ i ] = mix( next[ i ], c ); }
+			}
+			sorted = next;
+			std::sort( sorted.begin(), sorted.end() );
+			const uint32_t next_num_colours = std::unique( sorted.begin(), sorted.end() ) - sorted.begin();
+			if( next_num_colours == num_colours ) { break; }
+			nbhd.colours.swap( next );
+			num_colours = next_num_colours;
+		}
+		
+		/* Hash the sizes and the multiset of stable colours. */
+		sorted = nbhd.colours;
+		std::sort( sorted.begin(), sorted.end() );
+		nbhd.invariant = mix( mix( 0, d ), nbhd.num_edges );
+		for( auto const c : sorted ) { nbhd.invariant = mix( nbhd.invariant, c ); }
+		return nbhd;
+	}
+	
+	/**
+	 * Determines whether two neighbourhoods are isomorphic with an iterative 
+	 * backtracking search for a colour-preserving bijection from a to b. The 
+	 * vertices of a are mapped in order of increasing colour class size, so 
+	 * that the most constrained choices are made first.
+	 */
+	bool are_isomorphic( Neighbourhood const& a, Neighbourhood const& b ) {
+		
+		const uint32_t d = a.colours.size();
+		if( d != b.colours.size() || a.num_edges != b.num_edges ) { return false; }
+		
+		/* Sort the vertices of both graphs by colour and verify that the 
+		 * colour multisets agree (hashes alone could collide). */
+		std::vector< uint32_t > a_by_colour( d ), b_by_colour( d );
+		for( uint32_t i = 0; i < d; ++i ) { a_by_colour[ i ] = b_by_colour[ i ] = i; }
+		std::sort( a_by_colour.begin(), a_by_colour.end(), [ &a ]( const uint32_t x, const uint32_t y ) {
+			return a.colours[ x ] < a.colours[ y ];
+		} );
+		std::sort( b_by_colour.begin(), b_by_colour.end(), [ &b ]( const uint32_t x, const uint32_t y ) {
+			return b.colours[ x ] < b.colours[ y ];
+		} );
+		for( uint32_t i = 0; i < d; ++i ) {
+			if( a.colours[ a_by_colour[ i ] ] != b.colours[ b_by_colour[ i ] ] ) { return false; }
+		}
+		
+		/* Record for each vertex of a the range of b_by_colour that holds its 
+		 * candidates, then order a's vertices by the size of that range. */
+		std::vector< uint32_t > range_start( d ), range_end( d );
+		for( uint32_t i = 0; i < d; ) {
+			uint32_t j = i;
+			while( j < d && a.colours[ a_by_colour[ j ] ] == a.colours[ a_by_colour[ i ] ] ) { ++j; }
+			for( uint32_t p = i; p < j; ++p ) {
+				range_start[ a_by_colour[ p ] ] = i;
+				range_end[ a_by_colour[ p ] ] = j;
+			}
+			i = j;
+		}
+		std::vector< uint32_t > order( a_by_colour );
+		std::stable_sort( order.begin(), order.end(), [ &range_start, &range_end ]( const uint32_t x, const uint32_t y ) {
+			return range_end[ x ] - range_start[ x ] < range_end[ y ] - range_start[ y ];
+		} );
+		
+		/* Depth-first search, with an explicit cursor into each candidate range. */
+		std::vector< uint32_t > map( d, UNMAPPED ), inverse( d, UNMAPPED ), cursor( d );
+		int64_t depth = 0;
+		if( d > 0 ) { cursor[ 0 ] = range_start[ order[ 0 ] ]; }
+		while( depth >= 0 ) {
+			if( depth == d ) { return true; }
+			
+			/* Undo the previous choice at this depth, if any. */
+			const uint32_t i = order[ depth ];
+			if( map[ i ] != UNMAPPED ) {
+				inverse[ map[ i ] ] = UNMAPPED;
+				map[ i ] = UNMAPPED;
+			}
+			
+			/* Advance to the next candidate that preserves adjacency to every 
+			 * vertex mapped so far. */
+			bool found = false;
+			while( !found && cursor[ depth ] < range_end[ i ] ) {
+				const uint32_t j = b_by_colour[ cursor[ depth ]++ ];
+				if( inverse[ j ] != UNMAPPED || a.adjacency[ i ].size() != b.adjacency[ j ].size() ) { continue; }
+				uint32_t mapped_neighbours = 0;
+				found = true;
+				for( auto const x : a.adjacency[ i ] ) {
+					if( map[ x ] == UNMAPPED ) { continue; }
+					++mapped_neighbours;
+					if( !std::binary_search( b.adjacency[ j ].cbegin(), b.adjacency[ j ].cend(), map[ x ] ) ) {
+						found = false;
+						break;
+					}
+				}
+				if( found ) {
+					for( auto const y : b.adjacency[ j ] ) {
+						if( inverse[ y ] != UNMAPPED ) { --mapped_neighbours; }
+					}
+					found = ( mapped_neighbours == 0 );
+				}
+				if( found ) {
+					map[ i ] = j;
+					inverse[ j ] = i;
+				}
+			}
+			
+			if( found ) {
+				++depth;
+				if( depth < d ) { cursor[ depth ] = range_start[ order[ depth ] ]; }
+			}
+			else { --depth; }
+		}
+		return false;
+	}
+}
+
+ClassSizeHistogram class_size_histogram( std::vector< uint32_t > const& classes ) {
+	
+	/* First count the members of each class. */
+	std::map< uint32_t, uint32_t > class_sizes;
+	for( auto const c : classes ) { ++class_sizes[ c ]; }
+	
+	/* Then every member of a class of size s contributes to bucket s. */
+	ClassSizeHistogram histogram;
+	for( auto const& class_size : class_sizes ) { histogram[ class_size.second ] += class_size.second; }
+	return histogram;
+}
+
+std::vector< uint32_t > UnlabelledGraph::neighbourhood_classes() const {
+	
+	/* Phase 1: compute the invariant hash of every neighbourhood. */
+	std::vector< std::pair< uint64_t, uint32_t > > hashes( n_ );
+#pragma omp parallel
+	{
+		std::vector< uint32_t > global_to_local( n_, UNMAPPED );
+#pragma omp for schedule( dynamic, 64 )
+		for( uint32_t v = 0; v < n_; ++v ) {
+			hashes[ v ] = std::make_pair( extract_neighbourhood( adjacency_list_, v, &global_to_local ).invariant, v );
+		}
+	}
+	
+	/* Group vertices with equal hashes; only these need exact comparison. */
+	std::sort( hashes.begin(), hashes.end() );
+	std::vector< uint32_t > group_starts;
+	for( uint32_t i = 0; i < n_; ++i ) {
+		if( i == 0 || hashes[ i ].first != hashes[ i - 1 ].first ) { group_starts.push_back( i ); }
+	}
+	group_starts.push_back( n_ );
+	const uint32_t num_groups = group_starts.size() - 1;
+	
+	/* Phase 2: split each group into isomorphism classes by comparing every 
+	 * member against one representative of each class found so far. */
+	std::vector< uint32_t > local_class( n_, 0 ), num_classes( num_groups, 1 );
+#pragma omp parallel
+	{
+		std::vector< uint32_t > global_to_local( n_, UNMAPPED );
+#pragma omp for schedule( dynamic )
+		for( uint32_t g = 0; g < num_groups; ++g ) {
+			if( group_starts[ g + 1 ] - group_starts[ g ] == 1 ) { continue; }
+			std::vector< Neighbourhood > representatives;
+			for( uint32_t i = group_starts[ g ]; i < group_starts[ g + 1 ]; ++i ) {
+				Neighbourhood nbhd = extract_neighbourhood( adjacency_list_, hashes[ i ].second, &global_to_local );
+				uint32_t c = 0;
+				while( c < representatives.size() && !are_isomorphic( representatives[ c ], nbhd ) ) { ++c; }
+				if( c == representatives.size() ) { representatives.push_back( std::move( nbhd ) ); }
+				local_class[ i ] = c;
+			}
+			num_classes[ g ] = representatives.size();
+		}
+	}
+	
+	/* Offset the per-group class ids so that they are globally unique. */
+	std::vector< uint32_t > classes( n_ );
+	uint32_t offset = 0;
+	for( uint32_t g = 0; g < num_groups; ++g ) {
+		for( uint32_t i = group_starts[ g ]; i < group_starts[ g + 1 ]; ++i ) {
+			classes[ hashes[ i ].second ] = offset + local_class[ i ];
+		}
+		offset += num_classes[ g ];
+	}
+	return classes;
+}
+
+std::vector< ClassSizeHistogram > UnlabelledGraph::colour_refinement_profile() const {
+	
+	/* Start from the degree partition. */
+	std::vector< uint32_t > colours( n_ ), next_colours( n_ );
+	std::vector< uint64_t > hashes( n_ ), sorted_hashes;
+#pragma omp parallel for
+	for( uint32_t v = 0; v < n_; ++v ) { colours[ v ] = adjacency_list_[ v ].size(); }
+	
+	std::vector< ClassSizeHistogram > profile;
+	profile.push_back( class_size_histogram( colours ) );
+	uint64_t num_colours = 0;
+	for( auto const& bucket : profile.back() ) { num_colours += bucket.second / bucket.first; }
+	
+	while( num_colours < n_ ) {
+		
+		/* Hash each vertex's colour with the sorted colours of its neighbours. */
+#pragma omp parallel
+		{
+			std::vector< uint32_t > neighbour_colours;
+#pragma omp for schedule( dynamic, 256 )
+			for( uint32_t v = 0; v < n_; ++v ) {
+				neighbour_colours.clear();
+				for( auto const u : adjacency_list_[ v ] ) { neighbour_colours.push_back( colours[ u ] ); }
+				std::sort( neighbour_colours.begin(), neighbour_colours.end() );
+				uint64_t hash = mix( 0, colours[ v ] );
+				for( auto const c : neighbour_colours ) { hash = mix( hash, c ); }
+				hashes[ v ] = hash;
+			}
+		}
+		
+		/* Relabel the hashes with dense colour ids, in the second buffer. */
+		sorted_hashes = hashes;
+		std::sort( sorted_hashes.begin(), sorted_hashes.end() );
+		sorted_hashes.erase( std::unique( sorted_hashes.begin(), sorted_hashes.end() ), sorted_hashes.end() );
+		
+		/* Refinement only ever splits classes, so it has converged once 
+		 * the number of classes stops growing. */
+		if( sorted_hashes.size() == num_colours ) { break; }
+		num_colours = sorted_hashes.size();
+		
+#pragma omp parallel for
+		for( uint32_t v = 0; v < n_; ++v ) {
+			next_colours[ v ] = std::lower_bound( sorted_hashes.cbegin(), sorted_hashes.cend(), 
+				hashes[ v ] ) - sorted_hashes.cbegin();
+		}
+		colours.swap( next_colours );
+		profile.push_back( class_size_histogram( colours ) );
+	}
+	return profile;
+}
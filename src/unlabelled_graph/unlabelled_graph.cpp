@@ -36,14 +36,14 @@
 #include <cstring>		/* for ffs and std::string */
 #include <fstream>		/* for ifstream, infile */
 #include <sstream>		/* for istringstream, getline */
+#include <cassert>		/* for assert */
 
 /* STL stuff in use. */
 #include <vector>
 #include <unordered_set>
-#include <unordered_map>
 #include <queue>
 
-#include <numeric>		/* for std::accumulate() */
+#include <numeric>		/* for std::accumulate(), std::partial_sum() */
 
 #include "omp.h"
 
@@ -163,6 +163,37 @@ void UnlabelledGraph::add_vertices( const uint32_t num_vertices ) {
 	adjacency_list_.resize( n_ );
 }
 
+void UnlabelledGraph::apply_delta( GraphDelta const& delta ) {
+	
+	add_vertices( delta.num_new_vertices );
+	
+	/* Bucket the endpoints of the new edges by vertex with prefix sums, so 
+	 * that each NeighbourList is resized once and filled by only one thread. */
+	std::vector< uint32_t > offsets( n_ + 1, 0 );
+	for( auto const& e : delta.new_edges ) {
+		assert( e.first != e.second );
+		++offsets[ e.first + 1 ];
+		++offsets[ e.second + 1 ];
+	}
+	std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+	
+	std::vector< uint32_t > endpoints( offsets.back() );
+	std::vector< uint32_t > cursors( offsets.begin(), offsets.end() - 1 );
+	for( auto const& e : delta.new_edges ) {
+		endpoints[ cursors[ e.first ]++ ] = e.second;
+		endpoints[ cursors[ e.second ]++ ] = e.first;
+	}
+	
+#pragma omp parallel for schedule( dynamic, 256 )
+	for( uint32_t u = 0; u < n_; ++u ) {
+		if( offsets[ u ] == offsets[ u + 1 ] ) { continue; }
+		NeighbourList &neighbours = adjacency_list_[ u ];
+		neighbours.reserve( neighbours.size() + offsets[ u + 1 ] - offsets[ u ] );
+		neighbours.insert( endpoints.cbegin() + offsets[ u ], endpoints.cbegin() + offsets[ u + 1 ] );
+	}
+	m_ += delta.new_edges.size();
+}
+
 void UnlabelledGraph::add_random_edge() {
 
 	/* Error checking -- are there edges to add? */
@@ -207,22 +238,233 @@ bool UnlabelledGraph::populate_uniformly( const uint32_t num_edges ) {
 bool UnlabelledGraph::is_complete() const { return m_ == n_ * ( n_ - 1 ); }
 
 bool UnlabelledGraph::is_anonymous( const uint32_t k ) const {
+	return anonymity_violations( k ).empty();
+}
+
+DegreeHistogram UnlabelledGraph::degree_histogram() const {
+	
+	/* First find the maximum degree to size the dense histograms. */
+	uint32_t max_degree = 0;
+#pragma omp parallel for reduction( max: max_degree )
+	for( uint32_t i = 0; i < n_; ++i ) {
+		const uint32_t degree = adjacency_list_[ i ].size();
+		if( degree > max_degree ) { max_degree = degree; }
+	}
+	
+	DegreeHistogram histogram( max_degree + 1, 0 );
+	
+#pragma omp parallel
+	{
+		/* Count this thread's share of the vertices. */
+		DegreeHistogram my_histogram( max_degree + 1, 0 );
+#pragma omp for nowait
+		for( uint32_t i = 0; i < n_; ++i ) {
+			++my_histogram[ adjacency_list_[ i ].size() ];
+		}
+		
+		/* Then reduce into the shared histogram. */
+#pragma omp critical
+		{
+			for( uint32_t degree = 0; degree <= max_degree; ++degree ) {
+				histogram[ degree ] += my_histogram[ degree ];
+			}
+		}
+	}
+	return histogram;
+}
+
+std::map< uint32_t, uint32_t > UnlabelledGraph::anonymity_violations( const uint32_t k ) const {
 
 	/* First calculate the counts for every degree in the graph. */
-	std::unordered_map< uint32_t, uint32_t > degree_counts;
-	for( auto const& neighbours : adjacency_list_ ) {
-		const uint32_t next_degree = neighbours.size();
-		if( degree_counts.count( next_degree ) == 0 ) {
-			degree_counts[ next_degree ] = 1;
+	const DegreeHistogram histogram = degree_histogram();
+	
+	/* Then report every count that is non-zero but less than k. */
+	std::map< uint32_t, uint32_t > violations;
+	for( uint32_t degree = 0; degree < histogram.size(); ++degree ) {
+		if( histogram[ degree ] > 0 && histogram[ degree ] < k ) {
+			violations[ degree ] = histogram[ degree ];
+		}
+	}
+	return violations;
+}
+
+void UnlabelledGraph::supergraph_anonymize( const uint32_t k ) {
+	
+	assert( k <= n_ );
+	
+	while( !is_anonymous( k ) ) {
+		
+		/* First anonymize the current degree sequence. With fewer than 2k 
+		 * vertices, there is only one group, which takes the maximum degree. */
+		const DegreeSequence degrees = retrieve_degree_sequence();
+		DegreeSequence anon_degrees( degrees );
+		if( n_ < 2 * k ) {
+			for( auto &anon_degree : anon_degrees ) { anon_degree.first = degrees[ 0 ].first; }
+		}
+		else { anonymize_degree_sequence_parallel( &anon_degrees, k ); }
+		
+		/* Then try to realise the increases with edges among existing vertices. */
+		std::vector< uint32_t > increases( n_ );
+		for( uint32_t i = 0; i < n_; ++i ) {
+			increases[ degrees[ i ].second ] = anon_degrees[ i ].first - degrees[ i ].first;
 		}
-		else { ++degree_counts[ next_degree ]; }
+		
+		/* Probe with a random perturbation if no progress could be made. */
+		if( realise_degree_increases( &increases ) == 0 ) { add_random_edge(); }
 	}
+}
+
+uint32_t UnlabelledGraph::realise_degree_increases( std::vector< uint32_t > *increases ) {
+	
+	std::vector< uint32_t > &outstanding = *increases;
+	if( outstanding.empty() ) { return 0; }
+	const uint32_t max_increase = *std::max_element( outstanding.cbegin(), outstanding.cend() );
 	
-	/* Then ensure every count is at least k. */
-	for( auto const count : degree_counts ) {
-		if( count.second < k ) { return false; }
+	/* Bucket the vertices by outstanding increase, remembering each one's 
+	 * position within its bucket so that it can be moved in O(1). */
+	std::vector< std::vector< uint32_t > > buckets( max_increase + 1 );
+	std::vector< uint32_t > positions( n_ );
+	std::vector< uint32_t > unwanted; /* the vertices that want no new edges. */
+	for( uint32_t v = 0; v < n_; ++v ) {
+		if( outstanding[ v ] > 0 ) {
+			positions[ v ] = buckets[ outstanding[ v ] ].size();
+			buckets[ outstanding[ v ] ].push_back( v );
+		}
+		else { unwanted.push_back( v ); }
 	}
-	return true;
+	auto const remove = [ &buckets, &positions, &outstanding ]( const uint32_t v ) {
+		std::vector< uint32_t > &bucket = buckets[ outstanding[ v ] ];
+		const uint32_t moved = bucket.back();
+		bucket[ positions[ v ] ] = moved;
+		positions[ moved ] = positions[ v ];
+		bucket.pop_back();
+	};
+	
+	uint32_t num_edges_added = 0;
+	std::vector< uint32_t > partners;
+	for( uint32_t top = max_increase; top > 0; ) {
+		if( buckets[ top ].empty() ) { --top; continue; }
+		
+		/* Take the vertex with the largest outstanding increase... */
+		const uint32_t v = buckets[ top ].back();
+		remove( v );
+		
+		/* ...and probe downwards for the non-adjacent vertices with the next largest. */
+		partners.clear();
+		for( uint32_t b = top; b > 0 && partners.size() < outstanding[ v ]; --b ) {
+			for( auto it = buckets[ b ].crbegin(); it != buckets[ b ].crend(); ++it ) {
+				if( adjacency_list_[ v ].count( *it ) == 0 ) {
+					partners.push_back( *it );
+					if( partners.size() == outstanding[ v ] ) { break; }
+				}
+			}
+		}
+		
+		/* Connect them, moving each partner down one bucket. */
+		for( auto const u : partners ) {
+			add_edge( v, u );
+			remove( u );
+			if( --outstanding[ u ] > 0 ) {
+				positions[ u ] = buckets[ outstanding[ u ] ].size();
+				buckets[ outstanding[ u ] ].push_back( u );
+			}
+		}
+		num_edges_added += partners.size();
+		outstanding[ v ] -= partners.size();
+		
+		/* If too few vertices still want edges (typically for hubs), linearly probe 
+		 * from a random one of the vertices that never wanted any for some to 
+		 * absorb the rest. Their degrees overshoot, which the next round of 
+		 * anonymisation corrects. */
+		if( outstanding[ v ] == 0 || unwanted.empty() ) { continue; }
+		const uint32_t probe_start = rand() % unwanted.size();
+		for( uint32_t i = 0; i < unwanted.size() && outstanding[ v ] > 0; ++i ) {
+			if( add_edge( v, unwanted[ ( probe_start + i ) % unwanted.size() ] ) ) {
+				--outstanding[ v ];
+				++num_edges_added;
+			}
+		}
+	}
+	return num_edges_added;
+}
+
+uint32_t UnlabelledGraph::attach_by_utility( DegreeSequence const& degrees, 
+	DegreeSequence const& anon_degrees, const uint32_t num_pseudo_vertices, 
+	EdgeList *new_edges ) const {
+	
+	const uint32_t first_new_vertex = n_;
+	const uint32_t no_vertex = UINT32_MAX;
+	
+	/* Pseudo-vertices by tier: tiers[ 0, num_high ) have load low_load + 1 and 
+	 * tiers[ num_high, num_pseudo_vertices ) have load low_load. */
+	std::vector< uint32_t > tiers( num_pseudo_vertices ), position( num_pseudo_vertices );
+	for( uint32_t p = 0; p < num_pseudo_vertices; ++p ) { tiers[ p ] = position[ p ] = p; }
+	uint32_t num_high = 0;
+	
+	/* The range of new_edges holding each original vertex's attachments. */
+	std::vector< uint32_t > first_edge( n_, no_vertex ), last_edge( n_, no_vertex );
+	
+	/* Scratch space for scoring and selecting pseudo-vertices for one vertex. */
+	std::vector< uint32_t > score( num_pseudo_vertices, 0 ), chosen_by( num_pseudo_vertices, no_vertex );
+	std::vector< uint32_t > touched;
+	
+	for( uint32_t i = 0; i < n_; ++i ) {
+		const uint32_t u = degrees[ i ].second;
+		uint32_t deficiency = anon_degrees[ i ].first - degrees[ i ].first;
+		if( deficiency == 0 ) { continue; }
+		first_edge[ u ] = new_edges->size();
+		
+		/* Score each pseudo-vertex by the number of u's neighbours attached to it. */
+		touched.clear();
+		for( auto const w : adjacency_list_[ u ] ) {
+			if( first_edge[ w ] == no_vertex ) { continue; }
+			for( uint32_t e = first_edge[ w ]; e < last_edge[ w ]; ++e ) {
+				const uint32_t p = ( *new_edges )[ e ].second - first_new_vertex;
+				if( score[ p ]++ == 0 ) { touched.push_back( p ); }
+			}
+		}
+		std::sort( touched.begin(), touched.end(), [ &score ]( const uint32_t p, const uint32_t q ) {
+			return score[ p ] > score[ q ] || ( score[ p ] == score[ q ] && p < q );
+		} );
+		
+		/* Moves pseudo-vertex p up a tier and attaches u to it. */
+		auto const attach = [ & ]( const uint32_t p ) {
+			const uint32_t q = tiers[ num_high ];
+			std::swap( tiers[ position[ p ] ], tiers[ num_high ] );
+			std::swap( position[ p ], position[ q ] );
+			++num_high;
+			chosen_by[ p ] = u;
+			new_edges->push_back( std::make_pair( u, first_new_vertex + p ) );
+			--deficiency;
+		};
+		
+		/* Fill from the low tier, best-scoring first. Taking the whole tier 
+		 * empties it, promoting every pseudo-vertex to the (new) low tier. */
+		while( deficiency > 0 ) {
+			const uint32_t num_taken = std::min( deficiency, num_pseudo_vertices - num_high );
+			const uint32_t target = deficiency - num_taken;
+			for( auto it = touched.cbegin(); it != touched.cend() && deficiency > target; ++it ) {
+				if( position[ *it ] >= num_high && chosen_by[ *it ] != u ) { attach( *it ); }
+			}
+			for( uint32_t j = num_high; deficiency > target; ) {
+				if( chosen_by[ tiers[ j ] ] == u ) { ++j; }
+				else {
+					attach( tiers[ j ] );
+					j = std::max( j, num_high );
+				}
+			}
+			if( num_high == num_pseudo_vertices ) { num_high = 0; }
+		}
+		
+		last_edge[ u ] = new_edges->size();
+		for( auto const p : touched ) { score[ p ] = 0; }
+	}
+	
+	/* Relabel so that the heavier-loaded pseudo-vertices come first. */
+	for( uint32_t e = 0; e < new_edges->size(); ++e ) {
+		( *new_edges )[ e ].second = first_new_vertex + position[ ( *new_edges )[ e ].second - first_new_vertex ];
+	}
+	return num_high;
 }
 
 float UnlabelledGraph::get_occupancy() const {
@@ -233,18 +475,66 @@ float UnlabelledGraph::get_occupancy() const {
 
 DegreeSequence UnlabelledGraph::retrieve_degree_sequence() const {
 	
-	/* First create list of pairs. */
-	DegreeSequence degrees;
-	uint32_t i = 0;
-	std::transform( adjacency_list_.cbegin(), adjacency_list_.cend(), std::back_inserter( degrees ),
-		[ &i ]( auto const& neighbour_list ) {
-		 return std::make_pair( neighbour_list.size(), i++ );
-		}
-	);
+	/* Degrees are bounded by n, so counting sort them instead of comparison sorting. */
+	uint32_t max_degree = 0;
+#pragma omp parallel for reduction( max: max_degree )
+	for( uint32_t i = 0; i < n_; ++i ) {
+		const uint32_t degree = adjacency_list_[ i ].size();
+		if( degree > max_degree ) { max_degree = degree; }
+	}
+	const size_t num_buckets = static_cast< size_t >( max_degree ) + 1;
+	
+	DegreeSequence degrees( n_ );
+	std::vector< uint32_t > counts; /* one histogram of num_buckets per participating thread. */
+	size_t num_histograms = 1;
 	
-	/* Then sort them by descending degree. */
-	std::sort( degrees.begin(), degrees.end(), 
-		std::greater< std::pair< uint32_t, uint32_t > >() );
+#pragma omp parallel
+	{
+		/* Give each thread its own histogram only while all of them together 
+		 * take no more space than there are vertices, so that one high-degree 
+		 * hub cannot make the histograms (and their prefix sum) dwarf the graph. */
+#pragma omp single
+		{
+			num_histograms = std::max( static_cast< size_t >( 1 ), std::min( 
+				static_cast< size_t >( omp_get_num_threads() ), n_ / num_buckets ) );
+			counts.assign( num_histograms * num_buckets, 0 );
+		}
+		
+		/* Each participating thread takes a contiguous range of vertex ids. */
+		const size_t thread_id = omp_get_thread_num();
+		const uint32_t chunk = n_ / num_histograms + ( n_ % num_histograms ? 1 : 0 );
+		const uint32_t begin = thread_id < num_histograms ? std::min( n_, static_cast< uint32_t >( thread_id ) * chunk ) : n_;
+		const uint32_t end = std::min( n_, begin + chunk );
+		uint32_t * const my_counts = thread_id < num_histograms ? &counts[ thread_id * num_buckets ] : NULL;
+		
+		/* First build the histogram for this thread's vertices. */
+		for( uint32_t i = begin; i < end; ++i ) {
+			++my_counts[ adjacency_list_[ i ].size() ];
+		}
+		
+#pragma omp barrier
+		
+		/* Then convert the histograms to output offsets by a prefix sum in 
+		 * descending order of degree and, within a degree, of thread (and 
+		 * thus of vertex id). */
+#pragma omp single
+		{
+			uint32_t offset = 0;
+			for( size_t degree = num_buckets; degree-- > 0; ) {
+				for( size_t t = num_histograms; t-- > 0; ) {
+					const uint32_t count = counts[ t * num_buckets + degree ];
+					counts[ t * num_buckets + degree ] = offset;
+					offset += count;
+				}
+			}
+		}
+		
+		/* Finally scatter this thread's vertices, by descending id. */
+		for( uint32_t i = end; i-- > begin; ) {
+			const uint32_t degree = adjacency_list_[ i ].size();
+			degrees[ my_counts[ degree ]++ ] = std::make_pair( degree, i );
+		}
+	}
 
 	return degrees;
 }
@@ -87,6 +87,24 @@ namespace graphAnon
 		 */		
 		edgeList
 	};
+	
+	/** The supported strategies for attaching vertices to pseudo-vertices in hide_waldo(). */
+	enum class PseudoVertexPlacement {
+		/**
+		 * Deficient vertices are attached to the pseudo-vertices in round-robin 
+		 * order, as in Section 3.3 of @cite waldo .
+		 */
+		cyclic,
+		
+		/**
+		 * Deficient vertices are attached to the pseudo-vertices that already 
+		 * hold the most of their neighbours, among those whose load would remain 
+		 * balanced. This closes triangles and keeps the new paths of length two 
+		 * among vertices that are already adjacent, better preserving clustering 
+		 * and path lengths with the same number of new vertices and edges.
+		 */
+		utility
+	};
 }
 
 
@@ -104,6 +122,27 @@ typedef std::map< uint32_t, uint64_t > HopPlot;
  */
 typedef std::vector< std::pair< uint32_t, uint32_t > > DegreeSequence;
 
+/**
+ * A DegreeHistogram counts the vertices of each degree: its d'th element 
+ * is the number of vertices in a graph that have degree d.
+ */
+typedef std::vector< uint32_t > DegreeHistogram;
+
+/**
+ * A ClassSizeHistogram summarises a partition of the vertices into 
+ * equivalence classes: it maps each class size s to the number of vertices 
+ * that belong to a class of exactly s vertices. The smallest key is the 
+ * anonymity level of the partition.
+ */
+typedef std::map< uint32_t, uint32_t > ClassSizeHistogram;
+
+/**
+ * Summarises a partition of the vertices into equivalence classes.
+ * @param classes The class id of each vertex.
+ * @returns The ClassSizeHistogram of the partition.
+ */
+ClassSizeHistogram class_size_histogram( std::vector< uint32_t > const& classes );
+
 /**
  * A NeighbourList is a set of neighbours for a given vertex. 
  * If vertex i is in the list, then the vertex to whom this 
@@ -118,6 +157,22 @@ typedef std::unordered_set < uint32_t > NeighbourList;
  */
 typedef std::vector< NeighbourList > AdjacencyList;
 
+/**
+ * An EdgeList is a list of undirected edges, each given as a pair of 
+ * vertex ids.
+ */
+typedef std::vector< std::pair< uint32_t, uint32_t > > EdgeList;
+
+/**
+ * @brief A description of a supergraph of some graph: the number of 
+ * isolated vertices to append to the graph and then the new edges to 
+ * insert among its old and new vertices.
+ */
+struct GraphDelta {
+	uint32_t num_new_vertices; /**< The number of vertices to append. */
+	EdgeList new_edges; /**< The edges to insert, none of which exist yet. */
+};
+
 /**
  * @brief A simple, undirected, unlabelled graph with no self-loops that is
  * equipped with methods for identity disclosure protection.
@@ -258,6 +313,61 @@ public:
 	 */
 	bool is_anonymous( const uint32_t k ) const;
 	
+	/**
+	 * Counts the number of vertices of each degree in the UnlabelledGraph, 
+	 * accumulating per-thread partial histograms in parallel.
+	 * @returns A DegreeHistogram with one element for each degree from 0 
+	 * up to the maximum degree in the graph.
+	 */
+	DegreeHistogram degree_histogram() const;
+	
+	/**
+	 * Determines which degrees prevent the UnlabelledGraph from being 
+	 * k-degree-anonymous.
+	 * @param k The privacy threshold, k.
+	 * @returns A map from every degree that is shared by at least one but 
+	 * fewer than k vertices to the number of vertices that have it. The map 
+	 * is empty if and only if the graph is k-degree-anonymous.
+	 * @see is_anonymous()
+	 */
+	std::map< uint32_t, uint32_t > anonymity_violations( const uint32_t k ) const;
+	
+	/**
+	 * Partitions the vertices by the isomorphism class of their 
+	 * 1-hop neighbourhoods, i.e., the subgraph induced by their neighbours, 
+	 * as in k-neighbourhood anonymity @cite zhou .
+	 * 
+	 * Each neighbourhood is first reduced to a cheap invariant hash of its 
+	 * size, edge count, and colour-refined vertex colours. Neighbourhoods are 
+	 * only compared exactly, by backtracking search for an isomorphism that 
+	 * respects the refined colours, when their hashes collide. Both phases 
+	 * run in parallel.
+	 * @returns The class id of each vertex, such that two vertices share an 
+	 * id if and only if their neighbourhoods are isomorphic.
+	 * @warning The exact comparison is exponential in the worst case (e.g., for 
+	 * large, highly regular neighbourhoods that colour refinement cannot split).
+	 * @see class_size_histogram() to obtain the equivalence class sizes.
+	 */
+	std::vector< uint32_t > neighbourhood_classes() const;
+	
+	/**
+	 * Runs colour refinement (1-dimensional Weisfeiler-Lehman) to convergence, 
+	 * recording the anonymity of the vertices at every refinement depth. At 
+	 * depth 0, every vertex is coloured by its degree, so the classes are 
+	 * exactly those checked by is_anonymous(). At depth i+1, a vertex is 
+	 * coloured by its own colour at depth i together with the multiset of its 
+	 * neighbours' colours at depth i, modelling an adversary who iteratively 
+	 * learns more about a target's surroundings.
+	 * 
+	 * Each round hashes the sorted neighbour colours of all vertices in 
+	 * parallel into a second colour array, relabels the hashes with dense 
+	 * colour ids, and stops when the number of colours no longer grows.
+	 * @returns The ClassSizeHistogram of the colour classes at each depth, 
+	 * with the last entry being the stable partition.
+	 * @note Distinct multisets are distinguished up to 64-bit hash collisions.
+	 */
+	std::vector< ClassSizeHistogram > colour_refinement_profile() const;
+	
 	/**
 	 * Modifies the UnlabelledGraph so that it is k-degree-anonymous 
 	 * using the algorithm from @cite waldo .
@@ -265,6 +375,7 @@ public:
 	 * not the newly added vertices should also be anonymised. Note that 
 	 * the experiments in @cite waldo have this flag set to _false_.
 	 * @param k The privacy threshold, k.
+	 * @param placement How to attach the original vertices to the new ones.
 	 * @post The UnlabelledGraph is modified to be a super-graph with 
 	 * a larger vertex set and edge set such that it is k-degree-anonymous.
 	 * @see is_anonymous()
@@ -273,7 +384,58 @@ public:
 	 * equivalence class is not clearly defined.
 	 */
 	template < bool hide_new_vertices >
-	void hide_waldo( const uint32_t k );
+	void hide_waldo( const uint32_t k, 
+		const graphAnon::PseudoVertexPlacement placement = graphAnon::PseudoVertexPlacement::cyclic );
+	
+	/**
+	 * Modifies the UnlabelledGraph so that it is k-degree-anonymous by 
+	 * inserting edges among its existing vertices only, in the style of 
+	 * @cite terzi .
+	 * 
+	 * Each round anonymises the current degree sequence and then greedily 
+	 * realises the required degree increases as new edges (see 
+	 * realise_degree_increases()). If a round cannot realise the increases 
+	 * exactly, the next round starts from the augmented graph; if it adds no 
+	 * edge at all, a random edge is inserted so that the next round sees a 
+	 * different degree sequence. The process terminates because the complete 
+	 * graph is k-degree-anonymous for any k <= n.
+	 * @param k The privacy threshold, k.
+	 * @pre k <= n
+	 * @post The UnlabelledGraph is modified to be a super-graph with the same 
+	 * vertex set and a larger edge set such that it is k-degree-anonymous.
+	 * @see hide_waldo() for an alternative that adds vertices instead.
+	 */
+	void supergraph_anonymize( const uint32_t k );
+	
+	/**
+	 * Computes, without modifying the UnlabelledGraph, how hide_waldo() would 
+	 * k-degree-anonymise it for each of several privacy thresholds.
+	 * @tparam hide_new_vertices A boolean flag indicating whether or 
+	 * not the newly added vertices should also be anonymised.
+	 * @param ks The privacy thresholds, each of which must be at most n.
+	 * @param placement How to attach the original vertices to the new ones.
+	 * @returns One GraphDelta per threshold, in the same order as ks, 
+	 * such that applying the i'th GraphDelta is equivalent to invoking 
+	 * hide_waldo() with ks[ i ].
+	 * @note The degree sequence is computed once and shared; the thresholds 
+	 * are then processed concurrently.
+	 * @see apply_delta()
+	 */
+	template < bool hide_new_vertices >
+	std::vector< GraphDelta > hide_waldo_sweep( std::vector< uint32_t > const& ks, 
+		const graphAnon::PseudoVertexPlacement placement = graphAnon::PseudoVertexPlacement::cyclic ) const;
+	
+	/**
+	 * Transforms the UnlabelledGraph into the supergraph described by a GraphDelta.
+	 * @param delta The vertices and edges to add to the graph.
+	 * @pre None of the edges in delta already exist in the graph, and each 
+	 * appears only once.
+	 * @post The graph contains delta.num_new_vertices more vertices and 
+	 * all of the edges in delta.new_edges.
+	 * @note Rather than calling add_edge() per edge, the edges are bucketed by 
+	 * endpoint so that each NeighbourList grows once, in parallel.
+	 */
+	void apply_delta( GraphDelta const& delta );
 	
 	friend std::ostream& operator << ( std::ostream& os, UnlabelledGraph const& g );
 
@@ -287,7 +449,7 @@ protected:
 	 * @post Edge (u,v) exists in the graph (irrespective of whether it was there
 	 * prior to invoking the method)
 	 */
-	bool add_edge( const uint32_t u, const uint32_t v );
+	virtual bool add_edge( const uint32_t u, const uint32_t v );
 	
 	/**
 	 * Adds a specified number of isolated vertices to the graph.
@@ -311,10 +473,78 @@ protected:
 	 * @param degrees A vector to populate with the degree sequence, where each 
 	 * element is a pair of the form (degree, vertex id).
 	 * @post degrees is emptied and then populated with a list of degrees 
-	 * for each vertex, not necessarily unique and in ascending order.
+	 * for each vertex, not necessarily unique and in descending order of 
+	 * degree and then of vertex id.
+	 * @note Runs a parallel counting sort over degrees, which are bounded by n. 
+	 * Only as many threads keep their own histogram as fit in n counters, so 
+	 * a graph with a high-degree hub is sorted by fewer (possibly one).
 	 */
 	DegreeSequence retrieve_degree_sequence() const;
 
+	/**
+	 * Greedily inserts edges among existing vertices to raise their degrees by 
+	 * given amounts, in the manner of the Havel-Hakimi construction.
+	 * 
+	 * Vertices are kept in buckets indexed by their outstanding increase. The 
+	 * vertex with the largest outstanding increase r is repeatedly removed and 
+	 * connected to the r vertices with the next largest outstanding increases 
+	 * to which it is not yet adjacent, each of which then drops one bucket. 
+	 * If too few such vertices remain, the rest of its edges are made by 
+	 * probing linearly from a random vertex among those that wanted no new 
+	 * edges in the first place, whose degrees thus overshoot by one per 
+	 * probing vertex. Each such probe may scan all of them, i.e., O(n) time 
+	 * per vertex whose increase cannot be realised otherwise (typically a hub).
+	 * @param increases The number of new edges wanted at each vertex, indexed 
+	 * by vertex id.
+	 * @returns The number of edges that were inserted.
+	 * @post Every vertex that wanted new edges has received at most that many, 
+	 * and increases holds the number that could not be realised (all zero unless 
+	 * a vertex became adjacent to every vertex that wanted no new edges). 
+	 * Vertices that wanted none may have received some.
+	 */
+	uint32_t realise_degree_increases( std::vector< uint32_t > *increases );
+	
+	/**
+	 * Computes the pseudo-vertices and edges with which the algorithm from 
+	 * @cite waldo would k-degree-anonymise the UnlabelledGraph.
+	 * @tparam hide_new_vertices A boolean flag indicating whether or 
+	 * not the newly added vertices should also be anonymised.
+	 * @param degrees The degree sequence of the graph, as returned by 
+	 * retrieve_degree_sequence().
+	 * @param k The privacy threshold, k.
+	 * @param placement How to attach the original vertices to the new ones.
+	 * @returns The GraphDelta that makes the graph k-degree-anonymous.
+	 * @see hide_waldo()
+	 */
+	template < bool hide_new_vertices >
+	GraphDelta pseudo_vertex_delta( DegreeSequence const& degrees, const uint32_t k, 
+		const graphAnon::PseudoVertexPlacement placement ) const;
+	
+	/**
+	 * Attaches every deficient vertex to distinct pseudo-vertices with the 
+	 * graphAnon::PseudoVertexPlacement::utility strategy.
+	 * 
+	 * Pseudo-vertex loads are kept in two tiers, the minimum load and one 
+	 * more, exactly as the cyclic placement would leave them, so each vertex 
+	 * chooses among the minimum tier only. Within the tier, it prefers the 
+	 * pseudo-vertices to which the most of its neighbours are attached, which 
+	 * is exactly the number of triangles gained. As all candidates in a tier 
+	 * have equal load, this also minimises the number of non-adjacent vertices 
+	 * brought within distance two. The scores are accumulated from the 
+	 * attachments of the vertex's neighbours, so each vertex costs time linear 
+	 * in its degree plus its neighbours' deficiencies.
+	 * @param degrees The degree sequence of the graph.
+	 * @param anon_degrees The anonymised degree sequence.
+	 * @param num_pseudo_vertices The number of pseudo-vertices, with ids 
+	 * n, n+1, ...
+	 * @param new_edges The list to which the new edges are appended.
+	 * @returns The number of pseudo-vertices that received one more edge than the 
+	 * others. These are relabelled to be the lowest pseudo-vertex ids, just as 
+	 * with the cyclic placement.
+	 */
+	uint32_t attach_by_utility( DegreeSequence const& degrees, DegreeSequence const& anon_degrees, 
+		const uint32_t num_pseudo_vertices, EdgeList *new_edges ) const;
+
 	/**
 	 * Returns the path length between vertex u and vertex v.
 	 * @param u The id of the source vertex
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief A set of functions for unit testing the UnlabelledGraph class.
+ *
+ * @copyright Copyright (c) 2015-2017 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint> /* for uint32_t */
+#include <random>	/* for std::mt19937 */
+#include <vector>
+#include <algorithm>
+#include <map>
+
+#include "unlabelled_graph.test.h"
+#include "unlabelled_graph.h"
+
+/**
+ * Generates a pseudo-random degree sequence, sorted by descending degree, 
+ * with many repeated degrees.
+ * @param gen The random number generator from which to draw the sequence.
+ * @param n The length of the degree sequence.
+ * @param max_degree The largest degree that may appear in the sequence. 
+ * It is capped at n - 1 so that the sequence could belong to a simple graph.
+ */
+DegreeSequence random_degree_sequence( std::mt19937 &gen, const uint32_t n, 
+	const uint32_t max_degree ) {
+	
+	std::uniform_int_distribution< uint32_t > degree( 0, std::min( max_degree, n - 1 ) );
+	DegreeSequence degrees;
+	for( uint32_t i = 0; i < n; ++i ) {
+		degrees.push_back( std::make_pair( degree( gen ), i ) );
+	}
+	std::sort( degrees.begin(), degrees.end(), 
+		std::greater< std::pair< uint32_t, uint32_t > >() );
+	return degrees;
+}
+
+bool test_anonymize_degree_sequence() {
+
+	bool passed = true;
+	std::mt19937 gen( 2017 );
+	
+	/**
+	 * @test Equivalence with brute force
+	 * The monotone-deque dynamic programme must choose exactly the same 
+	 * splits as the exhaustive O(nk) one, including its tie-breaking on 
+	 * the sum of block costs. Short sequences over small degree ranges 
+	 * exercise many ties; longer ones exercise the sliding window.
+	 */
+	for( uint32_t trial = 0; trial < 500; ++trial ) {
+		const uint32_t n = 1 + trial % 97;
+		const uint32_t max_degree = 1 + ( trial * 7 ) % 40;
+		const uint32_t k = 1 + trial % 11;
+		
+		DegreeSequence expected = random_degree_sequence( gen, n, max_degree );
+		DegreeSequence actual( expected );
+		
+		const uint32_t expected_def = anonymize_degree_sequence_brute_force( &expected, k );
+		const uint32_t actual_def = anonymize_degree_sequence( &actual, k );
+		if( expected_def != actual_def || expected != actual ) { passed = false; }
+	}
+
+	return passed;
+}
+
+bool test_anonymize_degree_sequence_parallel() {
+
+	bool passed = true;
+	std::mt19937 gen( 2013 );
+	
+	/**
+	 * @test Equivalence of objective with sequential
+	 * Cutting the sequence inside long runs of equal degrees must not change 
+	 * the optimal maximum deficiency, and the stitched sequence must still 
+	 * be a k-anonymous increase of the original. Sequences over very few 
+	 * distinct degrees produce the long runs at which the cuts are made.
+	 */
+	for( uint32_t trial = 0; trial < 200; ++trial ) {
+		const uint32_t n = 50 + trial * 3;
+		const uint32_t max_degree = 1 + trial % 6;
+		const uint32_t k = 1 + trial % 9;
+		
+		const DegreeSequence original = random_degree_sequence( gen, n, max_degree );
+		DegreeSequence sequential( original );
+		DegreeSequence parallel( original );
+		
+		const uint32_t sequential_def = anonymize_degree_sequence( &sequential, k );
+		const uint32_t parallel_def = anonymize_degree_sequence_parallel( &parallel, k );
+		if( sequential_def != parallel_def ) { passed = false; }
+		
+		std::map< uint32_t, uint32_t > counts;
+		for( uint32_t i = 0; i < n; ++i ) {
+			if( parallel[ i ].second != original[ i ].second ) { passed = false; }
+			if( parallel[ i ].first < original[ i ].first ) { passed = false; }
+			if( parallel[ i ].first - original[ i ].first > parallel_def ) { passed = false; }
+			++counts[ parallel[ i ].first ];
+		}
+		for( auto const& count : counts ) {
+			if( count.second < k ) { passed = false; }
+		}
+	}
+
+	return passed;
+}
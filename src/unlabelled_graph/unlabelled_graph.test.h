@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief Definition of test methods for the UnlabelledGraph class.
+ *
+ * @copyright Copyright (c) 2015-2017 Sean Chester
+ * <br />
+ * This file is part of the GraphAnon suite.
+ * GraphAnon, version 2.0, is distributed freely under the *MIT License*:
+ * <br />
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * <br />
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * <br />
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UNLABELLED_GRAPH_TEST_H_
+#define UNLABELLED_GRAPH_TEST_H_
+
+/**
+ * Asserts the correctness of the anonymize_degree_sequence() function 
+ * by comparing it against anonymize_degree_sequence_brute_force() on a 
+ * series of pseudo-randomly generated degree sequences.
+ * @return True if all the tests pass; false if any test fails.
+ */
+bool test_anonymize_degree_sequence();
+
+/**
+ * Asserts the correctness of the anonymize_degree_sequence_parallel() function 
+ * by comparing its maximum deficiency against that of anonymize_degree_sequence() 
+ * and checking that its output is k-anonymous, on a series of pseudo-randomly 
+ * generated degree sequences with long runs of equal degrees.
+ * @return True if all the tests pass; false if any test fails.
+ */
+bool test_anonymize_degree_sequence_parallel();
+
+#endif /* UNLABELLED_GRAPH_TEST_H_ */
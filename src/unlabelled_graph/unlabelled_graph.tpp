@@ -30,7 +30,12 @@
 
 #include <unordered_set>
 #include <queue>
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>	/* for std::partition_point */
 #include <cassert>
+#include <cstdint>	/* for UINT32_MAX */
 
 #include "omp.h"
 
@@ -85,16 +90,19 @@ float UnlabelledGraph::average_path_length( HopPlot *hop_plot ) const {
 }
 
 /**
- * Optimally k-anonymizes the degree sequence such that max_deficiency is minimized.
+ * Optimally k-anonymizes the degree sequence such that max_deficiency is minimized, 
+ * by evaluating every admissible split position for every prefix of the sequence.
  * @param degrees The original degree sequence as pairs of (degree, vertex id)
  * @param k The privacy threshold, k.
  * @return The maximum deficiency calculated to transform the original degree sequence 
  * into a k-anonymous one.
  * @post The degree sequence, degrees, is modified such that every element that appears 
  * in the list appears at least k times.
+ * @note This method is O(nk) and primarily for testing purposes.
+ * @see anonymize_degree_sequence()
  * @see Section 3.1 and Table 1 of @cite waldo
  */
-uint32_t inline anonymize_degree_sequence( DegreeSequence *degrees, const uint32_t k ) {
+uint32_t inline anonymize_degree_sequence_brute_force( DegreeSequence *degrees, const uint32_t k ) {
 	
 	const uint32_t n = degrees->size();
 	
@@ -112,8 +120,8 @@ uint32_t inline anonymize_degree_sequence( DegreeSequence *degrees, const uint32
 	}
 	
 	/* arrays to store dynamic programming results. */
-	uint32_t costs[ n ];
-	uint32_t starts[ n ];
+	std::vector< uint32_t > costs( n );
+	std::vector< uint32_t > starts( n );
 	
 	/* trivially populate first 2k - 1 positions, since cannot split. */
 	for( uint32_t i = 0; i < 2 * k - 1; ++i ) {
@@ -168,54 +176,339 @@ uint32_t inline anonymize_degree_sequence( DegreeSequence *degrees, const uint32
 	return costs[ n - 1 ];
 }
 
+/**
+ * Optimally k-anonymizes a contiguous run of a degree sequence such that 
+ * max_deficiency is minimized.
+ * 
+ * Produces exactly the same splits as anonymize_degree_sequence_brute_force(), 
+ * but in O(n log k) time rather than O(nk). A candidate split j (the last 
+ * position of the left block) is scored for prefix i by the pair 
+ * (max(L_j, e_j - d_i), L_j + e_j - d_i), where L_j = costs[ j ] and 
+ * e_j is the degree at position j + 1. Since e_j is non-increasing in j and 
+ * the window of admissible splits only ever slides rightward, a candidate 
+ * that is matched or beaten in both L_j and e_j by a later candidate can never 
+ * be chosen again and is discarded. The surviving candidates are kept in a 
+ * deque in which L_j is non-decreasing and e_j is non-increasing, so the 
+ * best split lies at the crossover of the two terms and is found by binary search.
+ * @param d An iterator to the first element of the run, which consists of 
+ * pairs of (degree, vertex id) sorted by descending degree.
+ * @param n The length of the run.
+ * @param k The privacy threshold, k.
+ * @return The maximum deficiency calculated to transform the run 
+ * into a k-anonymous one.
+ * @pre n >= k, so that at least one block can be formed.
+ * @post The n elements starting at d are modified such that every element 
+ * that appears in the run appears at least k times.
+ * @see Section 3.1 and Table 1 of @cite waldo
+ */
+uint32_t inline anonymize_degree_subsequence( DegreeSequence::iterator const d, 
+	const uint32_t n, const uint32_t k ) {
+	
+	assert( n >= k );
+	
+	/* arrays to store dynamic programming results. */
+	std::vector< uint32_t > costs( n );
+	std::vector< uint32_t > starts( n );
+	
+	/* trivially populate first 2k - 1 positions, since cannot split. */
+	for( uint32_t i = 0; i < 2 * k - 1 && i < n; ++i ) {
+		starts[ i ] = 0;
+		costs[ i ] = d[ 0 ].first - d[ i ].first;
+	}
+	
+	/* deque of candidate split positions: every position is pushed exactly once, 
+	 * so a flat array with head and tail indices suffices. */
+	std::vector< uint32_t > candidates( n );
+	uint32_t head = 0;
+	uint32_t tail = 0;
+	
+	/* compute best split for remaining n - (2k - 1) positions. */
+	for( uint32_t i = 2 * k - 1; i < n; ++i ) {
+		const uint32_t range_end = i - k;
+		const uint32_t range_start = ( k - 1 > i - 2 * k + 1 ? k - 1 : i - 2 * k + 1 );
+		
+		/* admit range_end, discarding every candidate that it dominates. */
+		const uint32_t new_cost = costs[ range_end ];
+		const uint32_t new_degree = d[ range_end + 1 ].first;
+		while( tail > head ) {
+			const uint32_t j = candidates[ tail - 1 ];
+			if( new_cost < costs[ j ] || ( new_cost == costs[ j ] && new_degree < d[ j + 1 ].first ) ) {
+				--tail;
+			}
+			else { break; }
+		}
+		candidates[ tail++ ] = range_end;
+		
+		/* expire candidates that have slid out of the window. */
+		while( candidates[ head ] < range_start ) { ++head; }
+		
+		/* find the first candidate whose left cost dominates its right cost. */
+		const uint32_t degree_i = d[ i ].first;
+		auto const first = candidates.begin() + head;
+		auto const last = candidates.begin() + tail;
+		auto const crossover = std::partition_point( first, last,
+			[ &costs, &d, degree_i ]( uint32_t const pos ) {
+				return costs[ pos ] + degree_i < d[ pos + 1 ].first;
+			}
+		);
+		
+		uint32_t best_split = 0;
+		uint32_t best_cost = UINT32_MAX;
+		uint32_t best_sum = UINT32_MAX;
+		
+		/* left of crossover, the right cost dominates: the best is the earliest 
+		 * candidate with the same right cost as the last one. */
+		if( crossover != first ) {
+			const uint32_t degree_right = d[ *( crossover - 1 ) + 1 ].first;
+			const uint32_t j = *std::partition_point( first, crossover,
+				[ &d, degree_right ]( uint32_t const pos ) {
+					return d[ pos + 1 ].first > degree_right;
+				}
+			);
+			best_split = j;
+			best_cost = degree_right - degree_i;
+			best_sum = costs[ j ] + best_cost;
+		}
+		
+		/* at and beyond the crossover, the left cost dominates: the best is 
+		 * the crossover itself. */
+		if( crossover != last ) {
+			const uint32_t j = *crossover;
+			const uint32_t cost_left = costs[ j ];
+			const uint32_t sum_cost = cost_left + d[ j + 1 ].first - degree_i;
+			if( cost_left < best_cost || ( cost_left == best_cost && sum_cost < best_sum ) ) {
+				best_split = j;
+				best_cost = cost_left;
+				best_sum = sum_cost;
+			}
+		}
+		
+		starts[ i ] = best_split + 1;
+		costs[ i ] = best_cost;
+	}
+	
+	/* Update degrees to k-anonymize the degree sequence by replaying the
+	 * dynamic programming results backwards. 
+	 * Be aware of crazy loop logic arising from use of unsigned ints: 
+	 * the termination condition is when i == -1, which for unsigned ints 
+	 * means that i == max_int > n.
+	 */
+	for( uint32_t i = n - 1; i < n; i = starts[ i ] - 1 ) {
+		const uint32_t block_start = starts[ i ];
+		assert( block_start <= i );
+		const uint32_t block_degree = d[ block_start ].first;
+		for( uint32_t j = block_start + 1; j <= i; ++j ) {
+			d[ j ].first = block_degree;
+		}
+	}
+	
+	/* Return max deficiency. */
+	return costs[ n - 1 ];
+}
+
+
+/**
+ * Optimally k-anonymizes the degree sequence such that max_deficiency is minimized.
+ * @param degrees The original degree sequence as pairs of (degree, vertex id)
+ * @param k The privacy threshold, k.
+ * @return The maximum deficiency calculated to transform the original degree sequence 
+ * into a k-anonymous one.
+ * @post The degree sequence, degrees, is modified such that every element that appears 
+ * in the list appears at least k times.
+ * @see anonymize_degree_subsequence()
+ * @see Section 3.1 and Table 1 of @cite waldo
+ */
+uint32_t inline anonymize_degree_sequence( DegreeSequence *degrees, const uint32_t k ) {
+	
+	const uint32_t n = degrees->size();
+	
+	// Check if the graph is large enough to meaningfully anonymise. 
+	// Cannot split fewer than 2k vertices into two groups; so, a graph 
+	// of n < 2k vertices must already be transformed into the complete graph.
+	if( n < 2 * k )
+	{
+		uint32_t deficiency = 0;
+		for( uint32_t i = 1; i < n; ++i )
+		{
+			deficiency += degrees->at( 0 ).first - degrees->at( i ).first;
+		}
+		return deficiency;
+	}
+	
+	return anonymize_degree_subsequence( degrees->begin(), n, k );
+}
+
+/**
+ * Optimally k-anonymizes the degree sequence such that max_deficiency is minimized, 
+ * solving independent segments of the sequence concurrently.
+ * 
+ * The sequence is cut inside every run of at least 2k equal degrees, at k 
+ * positions past the start of the run. Such a cut is safe: given any optimal 
+ * grouping, the groups overlapping the run can be replaced by one group that 
+ * ends at the cut and one that starts after it. Both new groups have at least 
+ * k elements, and neither costs more than the group it replaces, because each 
+ * keeps the same extreme degree on one side and has the run's degree on the other. 
+ * Hence the maximum deficiency of the whole sequence is the maximum over 
+ * the segments, which are solved in parallel with anonymize_degree_subsequence().
+ * 
+ * The maximum deficiency is always equal to that of anonymize_degree_sequence(), 
+ * but ties among splits near a cut may be broken differently.
+ * @param degrees The original degree sequence as pairs of (degree, vertex id)
+ * @param k The privacy threshold, k.
+ * @return The maximum deficiency calculated to transform the original degree sequence 
+ * into a k-anonymous one.
+ * @post The degree sequence, degrees, is modified such that every element that appears 
+ * in the list appears at least k times.
+ * @see anonymize_degree_sequence()
+ */
+uint32_t inline anonymize_degree_sequence_parallel( DegreeSequence *degrees, const uint32_t k ) {
+	
+	const uint32_t n = degrees->size();
+	if( n < 2 * k ) { return anonymize_degree_sequence( degrees, k ); }
+	
+	/* Find the start of every segment: one cut per sufficiently long run. */
+	std::vector< uint32_t > segment_starts( 1, 0 );
+	for( uint32_t run_start = 0, i = 1; i <= n; ++i ) {
+		if( i == n || degrees->at( i ).first != degrees->at( run_start ).first ) {
+			if( i - run_start >= 2 * k ) { segment_starts.push_back( run_start + k ); }
+			run_start = i;
+		}
+	}
+	segment_starts.push_back( n );
+	
+	const uint32_t num_segments = segment_starts.size() - 1;
+	if( num_segments == 1 ) { return anonymize_degree_sequence( degrees, k ); }
+
+#ifndef NDEBUG
+	DegreeSequence sequential( *degrees );
+#endif
+	
+	/* Solve the segments independently and stitch by taking the worst deficiency. */
+	uint32_t max_def = 0;
+#pragma omp parallel for schedule( dynamic ) reduction( max: max_def )
+	for( uint32_t s = 0; s < num_segments; ++s ) {
+		const uint32_t segment_def = anonymize_degree_subsequence( 
+			degrees->begin() + segment_starts[ s ], 
+			segment_starts[ s + 1 ] - segment_starts[ s ], k );
+		if( segment_def > max_def ) { max_def = segment_def; }
+	}
+	
+	/* Verify the stitched objective against the sequential one. */
+	assert( max_def == anonymize_degree_sequence( &sequential, k ) );
+	
+	return max_def;
+}
+
 
 template < bool hide_new_vertices >
-void UnlabelledGraph::hide_waldo( const uint32_t k ) {
+GraphDelta UnlabelledGraph::pseudo_vertex_delta( DegreeSequence const& degrees, 
+	const uint32_t k, const graphAnon::PseudoVertexPlacement placement ) const {
 	
-	assert( k <= n_ );
+	GraphDelta delta;
+	delta.num_new_vertices = 0;
 	
 	/* Section 3.1: First anonymize degree sequence. */
-	DegreeSequence degrees = retrieve_degree_sequence();
 	DegreeSequence anon_degrees( degrees );
-	uint32_t max_def = anonymize_degree_sequence( &anon_degrees, k );
+	uint32_t max_def = anonymize_degree_sequence_parallel( &anon_degrees, k );
 	
 	/* Section 3.2: Augment graph with min # vertices. */ 
 	if( max_def > 0 ) {
 		const uint32_t first_new_vertex = n_;
 		if ( hide_new_vertices ) {
 			const uint32_t md_or_k = ( max_def > k ? max_def : k );
-			const uint32_t new_vertices = ( md_or_k % 2 ? md_or_k : md_or_k + 1 );
-			add_vertices( new_vertices );
+			delta.num_new_vertices = ( md_or_k % 2 ? md_or_k : md_or_k + 1 );
 		}
-		else { add_vertices( max_def ); }
+		else { delta.num_new_vertices = max_def; }
+		const uint32_t last_vertex = n_ + delta.num_new_vertices - 1;
 	
-		/* Section 3.3: Add new edges cyclically to anonymize original graph. */
+		/* Section 3.3: Add new edges cyclically to anonymize original graph. 
+		 * Every vertex receives at most max_def consecutive new vertices, 
+		 * so none of these edges is ever a duplicate. */
 		uint32_t cursor = first_new_vertex;
-		for( uint32_t i = 0; i < first_new_vertex; ++i ) {
-			const uint32_t deficiency = anon_degrees[ i ].first - degrees[ i ].first;
-			for( uint32_t j = 0; j < deficiency; ++j ) {
-				add_edge( degrees[ i ].second, cursor );
-				if( cursor == n_ - 1 ) { cursor = first_new_vertex; }
-				else { ++cursor; }
+		if( placement == graphAnon::PseudoVertexPlacement::utility ) {
+			cursor += attach_by_utility( degrees, anon_degrees, delta.num_new_vertices, &delta.new_edges );
+		}
+		else {
+			/* The e'th new edge goes to new vertex e mod #new vertices, so a prefix 
+			 * sum over the deficiencies places every vertex's edges independently. */
+			std::vector< uint32_t > first_edge( first_new_vertex + 1, 0 );
+			for( uint32_t i = 0; i < first_new_vertex; ++i ) {
+				first_edge[ i + 1 ] = first_edge[ i ] + anon_degrees[ i ].first - degrees[ i ].first;
 			}
+			delta.new_edges.resize( first_edge.back() );
+			
+#pragma omp parallel for schedule( dynamic, 1024 )
+			for( uint32_t i = 0; i < first_new_vertex; ++i ) {
+				for( uint32_t e = first_edge[ i ]; e < first_edge[ i + 1 ]; ++e ) {
+					delta.new_edges[ e ] = std::make_pair( degrees[ i ].second, 
+						first_new_vertex + e % delta.num_new_vertices );
+				}
+			}
+			cursor += first_edge.back() % delta.num_new_vertices;
 		}
 	
 		/* finally, check whether the new vertices are k-anonymous, or whether the 
-		 * pairing procedure is necessary. */
+		 * pairing procedure is necessary. The original vertices now have their 
+		 * anonymised degrees, and the new vertices before the cursor have one more 
+		 * edge than those at or after it. */
 		if( hide_new_vertices && cursor != first_new_vertex ) {
-			if( ! is_anonymous( k ) ) {
-				while( cursor < n_ - 1 ) {
-					add_edge( cursor, cursor + 1 );
+			std::map< uint32_t, uint32_t > degree_counts;
+			for( auto const& anon_degree : anon_degrees ) { ++degree_counts[ anon_degree.first ]; }
+			const uint32_t low_degree = delta.new_edges.size() / delta.num_new_vertices;
+			degree_counts[ low_degree + 1 ] += cursor - first_new_vertex;
+			degree_counts[ low_degree ] += last_vertex + 1 - cursor;
+			
+			const bool anonymous = std::all_of( degree_counts.cbegin(), degree_counts.cend(),
+				[ k ]( auto const& count ) { return count.second >= k; } );
+			
+			if( !anonymous ) {
+				/* The pairing may propose an edge twice, so skip repeats as add_edge() would. */
+				std::set< std::pair< uint32_t, uint32_t > > pairs;
+				auto const pair_up = [ &delta, &pairs ]( const uint32_t u, const uint32_t v ) {
+					if( pairs.insert( std::make_pair( std::min( u, v ), std::max( u, v ) ) ).second ) {
+						delta.new_edges.push_back( std::make_pair( u, v ) );
+					}
+				};
+				
+				while( cursor < last_vertex ) {
+					pair_up( cursor, cursor + 1 );
 					cursor += 2;
 				}
-				if( cursor == n_ - 1 ) {
-					add_edge( n_ - 1, first_new_vertex );
-					for( cursor = first_new_vertex + 1; cursor < n_; cursor += 2 ) {
-						add_edge( cursor, cursor + 1 );
+				if( cursor == last_vertex ) {
+					pair_up( last_vertex, first_new_vertex );
+					for( cursor = first_new_vertex + 1; cursor <= last_vertex; cursor += 2 ) {
+						pair_up( cursor, cursor + 1 );
 					}
 				}
 			}
 		}
 	}
-	return;
+	return delta;
+}
+
+
+template < bool hide_new_vertices >
+void UnlabelledGraph::hide_waldo( const uint32_t k, 
+	const graphAnon::PseudoVertexPlacement placement ) {
+	
+	assert( k <= n_ );
+	apply_delta( pseudo_vertex_delta< hide_new_vertices >( retrieve_degree_sequence(), k, placement ) );
+}
+
+
+template < bool hide_new_vertices >
+std::vector< GraphDelta > UnlabelledGraph::hide_waldo_sweep( 
+	std::vector< uint32_t > const& ks, const graphAnon::PseudoVertexPlacement placement ) const {
+	
+	/* The degree sequence is shared by every threshold, so retrieve it only once. */
+	const DegreeSequence degrees = retrieve_degree_sequence();
+	std::vector< GraphDelta > deltas( ks.size() );
+	
+	/* Then anonymise independently for each threshold. */
+#pragma omp parallel for schedule( dynamic )
+	for( uint32_t i = 0; i < ks.size(); ++i ) {
+		assert( ks[ i ] <= n_ );
+		deltas[ i ] = pseudo_vertex_delta< hide_new_vertices >( degrees, ks[ i ], placement );
+	}
+	return deltas;
 }